@@ -0,0 +1,61 @@
+#!/bin/sh
+# Regression check of process scheduler build against golden outputs in this directory:
+#  - CPUS states of all methods on shipped data (data/sched*.in), tick and event-driven engines
+#  - scheduling metrics of all methods on generated large trace (large.in), tick and event-driven engines
+#  - regression cases (max_time.in: simulation reaching the maximal time without checkpoints, burst list input rejected)
+#  - simulated ticks of benchmark combinations against baseline.txt, with --perf also their speed
+# usage: golden/check.sh [binary] [--perf [max slowdown percent] | --record-baseline]
+# Exit status is 1 if any check fails. Baseline speed depends on the machine, record it on the checking machine first.
+
+cd "$(dirname "$0")/.." || exit 1
+bin=./process_scheduler
+case "${1:-}" in
+    ""|--*) ;;
+    *) bin=$1; shift ;;
+esac
+jobs=$(nproc 2>/dev/null || echo 1)
+bench="--bench 0-9 1,64 1 --gen-jobs 200000 --seed 7 --bench-repeat 5"
+
+if [ "${1:-}" = "--record-baseline" ]; then
+    $bin $bench > golden/baseline.txt || exit 1
+    cat golden/baseline.txt
+    exit 0
+fi
+
+status=0
+for trace in data/sched*.in; do
+    name=$(basename "$trace" .in)
+    for engine in "" "--event --expand"; do
+        echo "$name $engine"
+        $bin --batch 0-9 1,2,4 1,2,3 --batch-dir "golden/$name" --batch-check --jobs "$jobs" $engine --input "$trace" ||
+            status=1
+    done
+done
+for engine in "" "--event"; do
+    echo "large $engine"
+    $bin --batch 0-9 1,4,64 1,2 --batch-dir golden/large --batch-check --metrics-only --jobs "$jobs" $engine \
+        --input golden/large.in || status=1
+done
+
+# regression cases, run in empty directory (no stray files may be left)
+case "$bin" in
+    /*) path=$bin ;;
+    *) path=$PWD/$bin ;;
+esac
+echo "max time"
+tmp=$(mktemp -d) || exit 1
+(cd "$tmp" && "$path" 0 1 --event --input "$OLDPWD/golden/max_time.in" > out) && cmp -s "$tmp/out" golden/max_time.out &&
+    [ "$(ls -A "$tmp")" = out ] || { echo "max time check failed"; status=1; }
+rm -rf "$tmp"
+echo "burst list"
+(printf '0 1 0 10/4/20/6/5\n\n' | "$path" 0 1) > /dev/null 2>&1 && { echo "burst list not rejected"; status=1; }
+
+echo "benchmark"
+if [ "${1:-}" = "--perf" ]; then
+    $bin $bench --baseline golden/baseline.txt --max-slowdown "${2:-20}" || status=1
+else
+    # speed is not compared (any slowdown passes), only simulated ticks
+    $bin $bench --baseline golden/baseline.txt --max-slowdown 100 || status=1
+fi
+[ $status -eq 0 ] && echo "all checks passed" || echo "CHECK FAILED"
+exit $status
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Records golden outputs checked by golden/check.sh:
+#  - CPUS states of methods 0-6 on shipped data (data/sched*.in) by the original program (baseline commit) with CPUS
+#    starting in sleep state (-1), the only change of its output made by this program
+#  - CPUS states of methods 7-9 on shipped data and metrics of all methods on generated large trace by given build
+# Golden outputs the unmodified original program (CPUS starting as 0) differs in are listed at the end.
+# usage: golden/record.sh [binary]
+# Needs git history with the baseline commit and a C++ compiler (CXX, default g++).
+
+cd "$(dirname "$0")/.." || exit 1
+bin=${1:-./process_scheduler}
+original=d2091e9 # baseline commit of the original program
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+git show "$original:main.cpp" > "$tmp/original.cpp" || exit 1
+sed 's/cpus_state(cpu_count);/cpus_state(cpu_count, -1);/' "$tmp/original.cpp" > "$tmp/idle.cpp"
+cmp -s "$tmp/original.cpp" "$tmp/idle.cpp" && { echo "sleep state start not applied to original program"; exit 1; }
+for program in original idle; do
+    ${CXX:-g++} -O2 -o "$tmp/$program" "$tmp/$program.cpp" || exit 1
+done
+
+differs=""
+for trace in data/sched*.in; do
+    name=$(basename "$trace" .in)
+    echo "$name"
+    mkdir -p "golden/$name"
+    for method in 0 1 2 3 4 5 6; do
+        for cpus in 1 2 4; do
+            for slice in 1 2 3; do
+                out=golden/$name/m${method}_c${cpus}_q${slice}.out
+                "$tmp/idle" $method $cpus $slice < "$trace" > "$out" || exit 1
+                "$tmp/original" $method $cpus $slice < "$trace" | cmp -s - "$out" || differs="$differs $out"
+            done
+        done
+    done
+    $bin --batch 7-9 1,2,4 1,2,3 --batch-dir "golden/$name" --input "$trace" || exit 1
+done
+echo "large"
+$bin --generate --gen-jobs 10000 --gen-exec-max 1000 --seed 7 > golden/large.in || exit 1
+$bin --batch 0-9 1,4,64 1,2 --batch-dir golden/large --metrics-only --input golden/large.in || exit 1
+
+echo "original program (CPUS starting as 0) differs in:"
+for out in $differs; do
+    echo "  $out"
+done
+exit 0
@@ -1,21 +1,49 @@
-#include <iostream>
 #include <vector>
-#include <sstream>
 #include <algorithm>
+#include <string>
+#include <limits>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <memory>
+#include <cstdint>
+#include <cctype>
+#include <cstddef>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <random>
+#include <chrono>
+#include <type_traits>
 
 /* Program description:
  * Program is simulating a process scheduler. Program executes with three arguments (arguments description below).
- * Program works in step mode i.e. firstly it reads input from stdin if there is any, secondly it executes a given
+ * Program works in step mode i.e. firstly it takes processes which arrival time has come, secondly it executes a given
  * schedule method, lastly it prints result of scheduling to stdout. (linefeeder.cpp and repeater.cpp not used).
+ * Input is read ahead into arrival queue sorted by arrival time, so simulation clock is independent of input lines
+ * (ticks between arrival times are simulated too and input lines might be out of order within look-ahead window).
  * Program ends if there is no input remaining and all CPUS are in sleep state.
+ * With --event option program runs event-driven engine which jumps straight to the next decision point (arrival,
+ * completion or RR slice expiry while processes wait) instead of simulating every single tick.
  *
  * Input data format:
  * t id prio exec_t
  * t -> time
  * id -> process id
  * prio -> process priority
- * exec_t -> process execution time
+ * exec_t -> process execution time, exec_t/burst/io -> execution time split into CPU bursts of burst ticks separated by
+ *           I/O bursts of io ticks (process is blocked and does not wait for CPU during I/O burst)
  * Note: multiple processes might be given in one line. Last input line must be an "enter" ('\n')
+ * Note: input might be also given as binary trace (see --to-binary), format is detected automatically
  *
  * Output data format:
  * t cpu1_state cpu2_state ...
@@ -23,10 +51,81 @@
  * cpu_state -> id of executing process or -1 (sleeping)
  * Note: number of columns is equal to the number of CPUS
  *
+ * Event-driven output data format (--event):
+ * t n cpu1_state cpu2_state ...
+ * t -> time of the first tick of the run
+ * n -> number of ticks the CPUS stay in given states
+ * Note: with --expand option runs are expanded back to the per tick output data format
+ *
  * Arguments:
  * arg1 -> schedule method (necessary)
  * arg2 -> number of CPUS (optional, default 1)
  * arg3 -> round robin slice time (optional, default 1)
+ * --event -> use event-driven engine (optional)
+ * --expand -> print event-driven engine output in per tick format (optional)
+ * --input file -> read input from memory mapped file (optional, default stdin)
+ * --to-binary -> convert input to binary trace and write it to output (optional)
+ * --to-text -> convert input (binary trace) to text input data format and write it to output (optional)
+ * --changes -> print only changes of CPUS states (optional)
+ * --binary-changes -> print only changes of CPUS states in binary format (optional)
+ * --decode-changes -> decode changes of CPUS states (text or binary) given as input to per tick output format
+ * --affinity -> keep executing processes on their CPUS, CPU states are printed per CPU (optional)
+ * --switch-cost n -> ticks CPU needs to switch to another process, implies --affinity (optional, default 0)
+ * --migration-cost n -> extra ticks when process is moved to another CPU, implies --affinity (multi-queue: ticks
+ *                       stolen process needs to migrate) (optional, default 0)
+ * --local-method m -> schedule method of multi-queue per CPU queues, 0 (FCFS) or 2 (SRTF) (optional, default 0)
+ * --steal-threshold n -> minimal number of waiting processes of CPU that idle CPU steals from (optional, default 1)
+ * --mlfq-levels n -> number of MLFQ levels, quantum of level l is rr_time * 2^l (optional, default 3)
+ * --mlfq-quanta q0,q1,... -> time quantum of every MLFQ level, overrides --mlfq-levels (optional)
+ * --mlfq-boost n -> period of moving all MLFQ processes to the first level (optional, default 0 - off)
+ * --min-granularity n -> minimal execution time of process before it is preempted by fair method (optional, default 1)
+ * --batch methods cpus rr_times -> parse input once and run every combination of given lists (e.g. 0-6 1-128 1,2) in
+ *                                  parallel, positional arguments are ignored (optional)
+ * --batch-dir dir -> directory of batch results, one file m<method>_c<cpus>_q<rr_time>.out per combination
+ *                    (optional, default .)
+ * --batch-check -> compare batch results with files of batch directory (golden outputs) instead of writing them, every
+ *                  difference is printed, exit status is 1 if there is any (optional)
+ * --jobs n -> number of batch (sweep) threads (optional, default number of hardware threads)
+ * --sweep methods cpus rr_times -> run every combination of given lists on every trace given as positional argument
+ *                                  (@file - file with one trace path per line, --input or stdin if none is given),
+ *                                  one metrics row per combination is printed as soon as it finishes (optional)
+ * --shard k/n -> run only k-th of n contiguous blocks of sweep combinations, e.g. on n nodes (optional, default 0/1)
+ * --capacity n -> expected maximal number of processes in simulation, records and queues are preallocated (optional)
+ * --backlog-limit n -> maximal number of processes in simulation, arrived processes over the limit wait for admission
+ *                     in order of arrival (optional, default 0 - no limit)
+ * --spill-limit n -> maximal number of processes waiting for admission kept in memory, others are spilled to temporary
+ *                   file (optional, default 1048576)
+ * --lookahead n -> number of input lines read ahead of simulation time, lines are sorted by arrival time within it
+ *                 (optional, default 1024)
+ * --cpu-threads n -> number of threads scheduling local queues and executing processes of CPUS of multi-queue method
+ *                    in parallel, output is the same as with one thread (optional, default 1)
+ * --checkpoint file -> write checkpoint of simulation state to file (replaced atomically) every --checkpoint-every
+ *                      ticks (optional)
+ * --checkpoint-every n -> number of simulated ticks between checkpoints (required with --checkpoint)
+ * --resume file -> continue simulation from checkpoint file with the same input, parameters of simulation are taken
+ *                  from checkpoint, regular output file longer than checkpointed output is truncated to it (optional)
+ * --metrics -> print summary of scheduling metrics after CPUS states (optional)
+ * --metrics-only -> print only summary of scheduling metrics (optional)
+ * --generate -> write synthetic workload as input trace (text or binary with --to-binary) instead of reading input
+ * --bench methods cpus rr_times -> run every combination of given lists on synthetic workload, print simulated ticks
+ *                                  per second and nanoseconds per tick of every combination (optional)
+ * --baseline file -> output of previous benchmark, ratio of ticks per second to it is printed for every combination and
+ *                   exit status is 1 if any combination is slower than --max-slowdown (optional)
+ * --max-slowdown p -> percent of ticks per second benchmark may lose against baseline (optional, default 10)
+ * --bench-repeat n -> run every benchmark combination n times, the fastest run is printed (optional, default 1)
+ * --gen-jobs n -> number of synthetic processes (optional, default 100000)
+ * --gen-rate r -> mean number of synthetic arrivals per tick, Poisson arrivals (optional, default 0.5)
+ * --gen-exec-min n -> minimal synthetic execution time (optional, default 1)
+ * --gen-exec-alpha a -> shape of Pareto distribution of synthetic execution times (optional, default 1.5)
+ * --gen-exec-max n -> maximal synthetic execution time (optional, default 100000)
+ * --gen-priorities w0,w1,... -> weights of synthetic priorities 0, 1, ... (optional, default 1,1,1,1)
+ * --seed n -> seed of synthetic workload (optional, default 1)
+ * --pipeline -> parse input, simulate and write output on separate threads (optional)
+ * --output-fd fd -> write output to given file descriptor (optional, default 1 - stdout)
+ *
+ * Note: compiled with -DSCHED_PROFILE program prints timing of simulation phases and queue depth statistics to stderr
+ * Note: compiled with -DSCHED_NO_MAIN main() is left out, so this file can be included (in one translation unit) to
+ *       embed the simulator through the scheduler class (library API)
  *
  * Implemented schedule methods (arg1):
  * 0 -> First Come First Serve (FCFS)
@@ -36,243 +135,4268 @@
  * 4 -> Priority with preemption same priorities scheduled using FCFS (lower the priority number higher the executing priority)
  * 5 -> Priority with preemption same priorities scheduled using SRTF                       --"--
  * 6 -> Priority without preemption same priorities scheduled using FCFS                    --"--
+ * 7 -> Multi-queue with work stealing, per CPU queues scheduled using FCFS or SRTF (see --local-method), CPU states
+ *      are printed per CPU
+ * 8 -> Multi-level feedback queue (MLFQ), process that uses its time quantum is moved one level down, same levels are
+ *      scheduled using RR
+ * 9 -> Fair (CFS-like), process with the smallest virtual runtime (execution time weighted by priority) is executed
  */
 
 
-/*! structure that contains all necessary process data */
-struct proc_data{
-    int id; /*!< process id */
-    int priority; /*!< process priority */
-    unsigned int exec_time; /*!< process execution time */
-    unsigned int remaining_time; /*!< process remaining execution time */
+/*! structure that contains all necessary process data, execution counters updated every tick (remaining time, time of
+ *  current CPU burst, time slice and switch time) are kept by proc_pool in arrays of slots */
+struct proc_data{
+    int id; /*!< process id */
+    int priority; /*!< process priority */
+    unsigned int exec_time; /*!< process execution time */
+    unsigned int seq; /*!< process arrival sequence number (orders processes with same keys) */
+    unsigned int quantum; /*!< length of current time slice (RR, MLFQ, fair) or 0 if time slice does not end */
+    unsigned int level; /*!< process level (MLFQ) */
+    std::uint64_t vruntime; /*!< weighted virtual runtime without current time slice (fair) */
+    unsigned int round; /*!< last CPUS assignment the process was scheduled in (affinity mode) */
+    int cpu = -1; /*!< CPU the process is placed on or -1 (affinity mode) */
+    int last_cpu = -1; /*!< CPU the process was executed on the last time or -1 (affinity mode) */
+    unsigned int arrival_time; /*!< time process arrived */
+    unsigned int run_end; /*!< tick after the last observed execution of process (metrics) */
+    bool started; /*!< flag for process that was dispatched at least once (metrics) */
+    unsigned int burst_time; /*!< length of CPU bursts separated by I/O bursts or 0 (one CPU burst, no I/O) */
+    unsigned int io_time; /*!< length of I/O bursts (process is blocked) */
+
+    /*! returns sum of I/O bursts of process (one after every CPU burst except the last one) */
+    unsigned int io_total() const
+    {
+        return burst_time == 0 || exec_time <= burst_time ? 0 : (exec_time - 1) / burst_time * io_time;
+    }
+};
+/*! writer of binary snapshot of simulation state (checkpoint), values are written in native byte order, vectors are
+ *  prefixed by their size */
+class snapshot_writer
+{
+public:
+    /*! creates snapshot file */
+    explicit snapshot_writer(const std::string& path) : file(std::fopen(path.c_str(), "wb"))
+    {
+        if(file == nullptr) throw std::runtime_error("cannot create checkpoint file " + path);
+    }
+    ~snapshot_writer()
+    {
+        if(file != nullptr) std::fclose(file);
+    }
+    snapshot_writer(const snapshot_writer&) = delete;
+    snapshot_writer& operator = (const snapshot_writer&) = delete;
+
+    /*! writes value of trivially copyable type */
+    template<typename T>
+    void put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        write(&value, sizeof(T));
+    }
+    /*! writes vector of trivially copyable values with its size */
+    template<typename T>
+    void put(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        put<std::uint64_t>(values.size());
+        write(values.data(), values.size() * sizeof(T));
+    }
+    /*! writes bytes */
+    void write(const void* data, std::size_t size)
+    {
+        if(size != 0 && std::fwrite(data, 1, size, file) != size) throw std::runtime_error("checkpoint write failed");
+    }
+    /*! writes buffered data to disk and closes snapshot file */
+    void close()
+    {
+        bool failed = std::fflush(file) != 0 || ::fsync(::fileno(file)) != 0;
+        failed = std::fclose(file) != 0 || failed;
+        file = nullptr;
+        if(failed) throw std::runtime_error("checkpoint write failed");
+    }
+
+private:
+    std::FILE* file; /*!< snapshot file */
+};
+
+/*! reader of binary snapshot written by snapshot_writer, reads are checked against the file size */
+class snapshot_reader
+{
+public:
+    /*! opens snapshot file */
+    explicit snapshot_reader(const std::string& path) : file(std::fopen(path.c_str(), "rb"))
+    {
+        if(file == nullptr) throw std::invalid_argument("cannot open checkpoint file " + path);
+        struct stat st{};
+        if(::fstat(::fileno(file), &st) == 0) remaining = static_cast<std::uint64_t>(st.st_size);
+    }
+    ~snapshot_reader() {std::fclose(file);}
+    snapshot_reader(const snapshot_reader&) = delete;
+    snapshot_reader& operator = (const snapshot_reader&) = delete;
+
+    /*! reads value of trivially copyable type */
+    template<typename T>
+    void get(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        read(&value, sizeof(T));
+    }
+    template<typename T>
+    T get()
+    {
+        T value;
+        get(value);
+        return value;
+    }
+    /*! reads vector of trivially copyable values written with its size */
+    template<typename T>
+    void get(std::vector<T>& values)
+    {
+        values.clear();
+        append(values, get<std::uint64_t>());
+    }
+    /*! reads count values to the end of vector */
+    template<typename T>
+    void append(std::vector<T>& values, std::uint64_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        if(count > remaining / sizeof(T)) throw std::invalid_argument("invalid checkpoint (truncated)");
+        std::size_t size = values.size();
+        values.resize(size + static_cast<std::size_t>(count));
+        read(values.data() + size, static_cast<std::size_t>(count) * sizeof(T));
+    }
+    /*! reads bytes */
+    void read(void* data, std::size_t size)
+    {
+        if(size > remaining || (size != 0 && std::fread(data, 1, size, file) != size))
+            throw std::invalid_argument("invalid checkpoint (truncated)");
+        remaining -= size;
+    }
+
+private:
+    std::FILE* file; /*!< snapshot file */
+    std::uint64_t remaining = 0; /*!< number of not read bytes */
+};
+
+/*! streaming histogram of non-negative values with logarithmic buckets (relative error below 1/32), percentiles are
+ *  computed without keeping the values */
+class latency_histogram
+{
+public:
+    latency_histogram() : buckets((64 - sub_bits + 1) << sub_bits) {}
+
+    /*! adds value */
+    void add(std::uint64_t value)
+    {
+        ++buckets[bucket(value)];
+        ++total;
+        values_sum += value;
+        max = std::max(max, value);
+    }
+    /*! returns approximate percentile (upper bound of bucket containing it, at most the maximal value) */
+    std::uint64_t percentile(double percent) const
+    {
+        auto rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(total)));
+        std::uint64_t count = 0;
+        for(std::size_t i = 0; i < buckets.size(); ++i)
+        {
+            count += buckets[i];
+            if(count >= std::max<std::uint64_t>(rank, 1)) return std::min(upper_bound(i), max);
+        }
+        return max;
+    }
+    /*! adds values of other histogram */
+    void merge(const latency_histogram& other)
+    {
+        for(std::size_t i = 0; i < buckets.size(); ++i)
+            buckets[i] += other.buckets[i];
+        total += other.total;
+        values_sum += other.values_sum;
+        max = std::max(max, other.max);
+    }
+    double mean() const {return total == 0 ? 0.0 : static_cast<double>(values_sum) / static_cast<double>(total);}
+    std::uint64_t sum() const {return values_sum;}
+    std::uint64_t maximum() const {return max;}
+    std::uint64_t count() const {return total;}
+    /*! writes histogram to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(buckets);
+        snapshot.put(total);
+        snapshot.put(values_sum);
+        snapshot.put(max);
+    }
+    /*! reads histogram from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        std::size_t size = buckets.size();
+        snapshot.get(buckets);
+        if(buckets.size() != size) throw std::invalid_argument("invalid checkpoint (histogram)");
+        snapshot.get(total);
+        snapshot.get(values_sum);
+        snapshot.get(max);
+    }
+
+private:
+    static constexpr unsigned int sub_bits = 5; /*!< values below 2^sub_bits have exact buckets */
+
+    /*! returns bucket index of value */
+    static std::size_t bucket(std::uint64_t value)
+    {
+        if(value < (1u << sub_bits)) return static_cast<std::size_t>(value);
+        unsigned int shift = 63 - static_cast<unsigned int>(__builtin_clzll(value)) - sub_bits;
+        return (static_cast<std::size_t>(shift + 1) << sub_bits) + static_cast<std::size_t>((value >> shift) - (1u << sub_bits));
+    }
+    /*! returns the biggest value of bucket */
+    static std::uint64_t upper_bound(std::size_t index)
+    {
+        if(index < (1u << sub_bits)) return index;
+        unsigned int shift = static_cast<unsigned int>(index >> sub_bits) - 1;
+        std::uint64_t low = static_cast<std::uint64_t>((index & ((1u << sub_bits) - 1)) + (1u << sub_bits)) << shift;
+        return low + ((std::uint64_t(1) << shift) - 1);
+    }
+
+    std::vector<std::uint64_t> buckets; /*!< number of values in every bucket */
+    std::uint64_t total = 0; /*!< number of values */
+    std::uint64_t values_sum = 0; /*!< sum of values */
+    std::uint64_t max = 0; /*!< maximal value */
+};
+
+#ifdef SCHED_PROFILE
+/*! phases of simulation timed by profiler (compiled with -DSCHED_PROFILE) */
+enum class profile_phase {parse, schedule, cpus_state, place, update, output, count};
+
+/*! per thread timing and queue depth counters, merged into global counters when thread ends */
+class profiler
+{
+public:
+    ~profiler() {merge_into(global());}
+
+    /*! returns profiler of calling thread */
+    static profiler& instance()
+    {
+        thread_local profiler local;
+        return local;
+    }
+    /*! accounts one execution of phase */
+    void add(profile_phase phase, std::uint64_t ns) {phases[static_cast<std::size_t>(phase)].add(ns);}
+    /*! accounts number of waiting processes at decision point */
+    void queue_depth(std::size_t depth) {depths.add(depth);}
+
+    /*! prints counters of all ended threads and calling thread to stderr */
+    static void report()
+    {
+        instance().merge_into(global());
+        profiler& all = global();
+        const char* names[] = {"parse", "schedule", "cpus_state", "place", "update", "output"};
+        std::fprintf(stderr, "phase calls total_ms mean_ns p50_ns p99_ns max_ns (exclusive time)\n");
+        for(std::size_t i = 0; i < static_cast<std::size_t>(profile_phase::count); ++i)
+        {
+            const latency_histogram& h = all.phases[i];
+            std::fprintf(stderr, "%s %llu %.3f %.1f %llu %llu %llu\n", names[i], ull(h.count()), h.sum() / 1e6, h.mean(),
+                         ull(h.percentile(50)), ull(h.percentile(99)), ull(h.maximum()));
+        }
+        std::fprintf(stderr, "queue_depth samples %llu mean %.2f p50 %llu p99 %llu max %llu\n", ull(all.depths.count()),
+                     all.depths.mean(), ull(all.depths.percentile(50)), ull(all.depths.percentile(99)),
+                     ull(all.depths.maximum()));
+    }
+
+private:
+    profiler() = default;
+
+    static unsigned long long ull(std::uint64_t value) {return static_cast<unsigned long long>(value);}
+    /*! returns counters of ended threads */
+    static profiler& global()
+    {
+        static profiler all;
+        return all;
+    }
+    /*! moves counters to other profiler */
+    void merge_into(profiler& other)
+    {
+        if(&other == this) return;
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        for(std::size_t i = 0; i < static_cast<std::size_t>(profile_phase::count); ++i)
+        {
+            other.phases[i].merge(phases[i]);
+            phases[i] = latency_histogram();
+        }
+        other.depths.merge(depths);
+        depths = latency_histogram();
+    }
+
+    latency_histogram phases[static_cast<std::size_t>(profile_phase::count)]; /*!< durations of phases in ns */
+    latency_histogram depths; /*!< numbers of waiting processes */
+};
+
+/*! times scope as given phase, exclusive time is accounted (time of nested scopes is accounted to their phases only) */
+class profile_scope
+{
+public:
+    explicit profile_scope(profile_phase phase)
+        : phase(phase), parent(current()), begin(std::chrono::steady_clock::now()) {current() = this;}
+    ~profile_scope()
+    {
+        auto ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+        current() = parent;
+        if(parent != nullptr) parent->nested += ns;
+        profiler::instance().add(phase, ns - std::min(nested, ns));
+    }
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator = (const profile_scope&) = delete;
+
+private:
+    /*! returns the innermost scope of calling thread */
+    static profile_scope*& current()
+    {
+        thread_local profile_scope* scope = nullptr;
+        return scope;
+    }
+
+    profile_phase phase; /*!< timed phase */
+    profile_scope* parent; /*!< enclosing scope or nullptr */
+    std::chrono::steady_clock::time_point begin; /*!< beginning of scope */
+    std::uint64_t nested = 0; /*!< time of nested scopes in ns */
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+/*! times rest of the current scope as given phase */
+#define PROFILE_SCOPE(phase) profile_scope PROFILE_CONCAT(profile_scope_, __LINE__)(profile_phase::phase)
+/*! accounts number of waiting processes */
+#define PROFILE_QUEUE_DEPTH(depth) profiler::instance().queue_depth(depth)
+/*! prints profile to stderr */
+#define PROFILE_REPORT() profiler::report()
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_QUEUE_DEPTH(depth)
+#define PROFILE_REPORT()
+#endif
+
+/*! arena of equally sized blocks allocated in big chunks, freed blocks are reused (node allocations of containers),
+ *  block size is set by the first allocation */
+class block_arena
+{
+public:
+    block_arena() = default;
+    block_arena(const block_arena&) = delete;
+    block_arena& operator = (const block_arena&) = delete;
+
+    /*! returns block of given size or nullptr if size differs from arena block size */
+    void* allocate(std::size_t size)
+    {
+        if(block_size == 0) block_size = round_up(size);
+        if(round_up(size) != block_size) return nullptr;
+        if(free_block != nullptr)
+        {
+            void* block = free_block;
+            free_block = *static_cast<void**>(block);
+            return block;
+        }
+        if(used == chunk_blocks) add_chunk(chunks.empty() ? std::max(first_chunk_blocks, min_chunk_blocks) : chunk_blocks * 2);
+        return chunks.back().get() + block_size * used++;
+    }
+    /*! returns block to the arena */
+    void deallocate(void* block)
+    {
+        *static_cast<void**>(block) = free_block;
+        free_block = block;
+    }
+    /*! sets number of blocks of the first chunk (capacity hint) */
+    void reserve(std::size_t count) {first_chunk_blocks = count;}
+    /*! checks if arena allocates blocks of given size */
+    bool fits(std::size_t size) const {return block_size == 0 || round_up(size) == block_size;}
+
+private:
+    static constexpr std::size_t min_chunk_blocks = 256; /*!< blocks of the first chunk */
+
+    /*! rounds size up to multiple of the fundamental alignment (block can hold a free list link) */
+    static std::size_t round_up(std::size_t size)
+    {
+        constexpr std::size_t align = alignof(std::max_align_t);
+        return (std::max(size, sizeof(void*)) + align - 1) / align * align;
+    }
+    /*! allocates new chunk of given number of blocks, rest of the previous chunk is not used */
+    void add_chunk(std::size_t count)
+    {
+        chunks.emplace_back(new char[block_size * count]);
+        chunk_blocks = count;
+        used = 0;
+    }
+
+    std::vector<std::unique_ptr<char[]>> chunks; /*!< allocated chunks */
+    std::size_t block_size = 0; /*!< size of blocks (0 - not set yet) */
+    std::size_t chunk_blocks = 0; /*!< blocks of the last chunk */
+    std::size_t used = 0; /*!< used blocks of the last chunk */
+    std::size_t first_chunk_blocks = 0; /*!< blocks of the first chunk (capacity hint) */
+    void* free_block = nullptr; /*!< first freed block (free list) */
+};
+
+/*! allocator of container nodes from block arena, other allocations (and allocations without arena) use operator new */
+template<typename T>
+struct arena_allocator
+{
+    using value_type = T;
+
+    explicit arena_allocator(block_arena* arena = nullptr) : arena(arena) {}
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t n)
+    {
+        void* block = n == 1 && arena != nullptr ? arena->allocate(sizeof(T)) : nullptr;
+        return static_cast<T*>(block != nullptr ? block : ::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n)
+    {
+        if(n == 1 && arena != nullptr && arena->fits(sizeof(T))) arena->deallocate(p);
+        else ::operator delete(p);
+    }
+    template<typename U>
+    bool operator == (const arena_allocator<U>& other) const {return arena == other.arena;}
+    template<typename U>
+    bool operator != (const arena_allocator<U>& other) const {return arena != other.arena;}
+
+    block_arena* arena; /*!< arena of nodes */
+};
+
+/*! pool of process records, slots are stable and reused through a list of free slots, processes are linked in
+ *  execution order through their slots (intrusive list), execution counters updated every tick are kept in separate
+ *  arrays of slots (structure of arrays) apart from the records */
+class proc_pool
+{
+public:
+    /*! puts arrived process to a free slot (not linked), its counters start with the whole execution time and the
+     *  first CPU burst, returns the slot */
+    int acquire(const proc_data& pd)
+    {
+        int slot = free_slot;
+        if(slot == -1)
+        {
+            slot = static_cast<int>(nodes.size());
+            nodes.push_back(node{});
+            remaining.push_back(0);
+            burst.push_back(0);
+            slice.push_back(0);
+            switching.push_back(0);
+        }
+        else free_slot = nodes[slot].next;
+        nodes[slot] = node{pd, -1, -1};
+        remaining[slot] = pd.exec_time;
+        burst[slot] = std::min(pd.burst_time, pd.exec_time);
+        slice[slot] = 0;
+        switching[slot] = 0;
+        ++acquired;
+        return slot;
+    }
+    /*! returns not linked slot to the free slots */
+    void release(int slot)
+    {
+        nodes[slot].next = free_slot;
+        free_slot = slot;
+        --acquired;
+    }
+    /*! links slot at the end of execution list */
+    void push_back(int slot)
+    {
+        nodes[slot].prev = tail;
+        nodes[slot].next = -1;
+        if(tail == -1) head = slot;
+        else nodes[tail].next = slot;
+        tail = slot;
+        ++linked;
+    }
+    /*! unlinks slot from execution list */
+    void unlink(int slot)
+    {
+        node& n = nodes[slot];
+        if(n.prev == -1) head = n.next;
+        else nodes[n.prev].next = n.next;
+        if(n.next == -1) tail = n.prev;
+        else nodes[n.next].prev = n.prev;
+        --linked;
+    }
+    int front() const {return head;} /*!< first slot of execution list (-1 if empty) */
+    int next(int slot) const {return nodes[slot].next;} /*!< next slot of execution list (-1 if last) */
+    std::size_t size() const {return linked;} /*!< number of linked processes */
+    std::size_t live() const {return acquired;} /*!< number of acquired slots (processes in simulation) */
+    /*! preallocates records and counters (capacity hint) */
+    void reserve(std::size_t capacity)
+    {
+        nodes.reserve(capacity);
+        remaining.reserve(capacity);
+        burst.reserve(capacity);
+        slice.reserve(capacity);
+        switching.reserve(capacity);
+    }
+    proc_data& operator[](int slot) {return nodes[slot].pd;}
+    const proc_data& operator[](int slot) const {return nodes[slot].pd;}
+    /*! remaining execution time of process */
+    unsigned int& remaining_time(int slot) {return remaining[slot];}
+    unsigned int remaining_time(int slot) const {return remaining[slot];}
+    /*! remaining execution time of current CPU burst of process (if its burst_time is given) */
+    unsigned int& burst_left(int slot) {return burst[slot];}
+    unsigned int burst_left(int slot) const {return burst[slot];}
+    /*! execution time of process in its current time slice */
+    unsigned int& slice_time(int slot) {return slice[slot];}
+    unsigned int slice_time(int slot) const {return slice[slot];}
+    /*! ticks remaining until process is switched in on its CPU (affinity mode) */
+    unsigned int& switch_time(int slot) {return switching[slot];}
+    unsigned int switch_time(int slot) const {return switching[slot];}
+
+    /*! static function returning ordering key of process in term of execution time (lower key first, same keys
+     *  ordered by arrival) */
+    static std::uint64_t key_exec_time(const proc_pool& pool, int slot) {return pool[slot].exec_time;}
+    /*! static function returning ordering key of process in term of priority */
+    static std::uint64_t key_priority(const proc_pool& pool, int slot) {return priority_key(pool[slot].priority);}
+    /*! static function returning ordering key of process in term of remaining execution time */
+    static std::uint64_t key_remaining_time(const proc_pool& pool, int slot) {return pool.remaining[slot];}
+    /*! static function returning ordering key of process in term of arrival (all keys same) */
+    static std::uint64_t key_arrival(const proc_pool&, int) {return 0;}
+    /*! static function returning ordering key of process in term of priority, same priorities in term of remaining
+     *  execution time */
+    static std::uint64_t key_priority_remaining_time(const proc_pool& pool, int slot)
+    {return (priority_key(pool[slot].priority) << 32) | pool.remaining[slot];}
+
+    /*! writes records, counters and lists to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(nodes);
+        snapshot.put(remaining);
+        snapshot.put(burst);
+        snapshot.put(slice);
+        snapshot.put(switching);
+        snapshot.put(head);
+        snapshot.put(tail);
+        snapshot.put(free_slot);
+        snapshot.put(linked);
+        snapshot.put(acquired);
+    }
+    /*! reads records, counters and lists from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(nodes);
+        snapshot.get(remaining);
+        snapshot.get(burst);
+        snapshot.get(slice);
+        snapshot.get(switching);
+        if(remaining.size() != nodes.size() || burst.size() != nodes.size() || slice.size() != nodes.size() ||
+           switching.size() != nodes.size())
+            throw std::invalid_argument("invalid checkpoint (process counters)");
+        snapshot.get(head);
+        snapshot.get(tail);
+        snapshot.get(free_slot);
+        snapshot.get(linked);
+        snapshot.get(acquired);
+    }
+
+private:
+    /*! process record with execution list links */
+    struct node
+    {
+        proc_data pd; /*!< process data */
+        int prev; /*!< previous slot of execution list or -1 */
+        int next; /*!< next slot of execution list, next free slot or -1 */
+    };
+
+    /*! maps priority to unsigned key with the same order */
+    static std::uint64_t priority_key(int priority) {return static_cast<std::uint32_t>(priority) ^ 0x80000000u;}
+
+    std::vector<node> nodes; /*!< process records */
+    std::vector<unsigned int> remaining; /*!< remaining execution time of every slot */
+    std::vector<unsigned int> burst; /*!< remaining execution time of current CPU burst of every slot */
+    std::vector<unsigned int> slice; /*!< execution time in current time slice of every slot */
+    std::vector<unsigned int> switching; /*!< ticks until process is switched in of every slot */
+    int head = -1; /*!< first slot of execution list */
+    int tail = -1; /*!< last slot of execution list */
+    int free_slot = -1; /*!< first free slot */
+    std::size_t linked = 0; /*!< number of linked processes */
+    std::size_t acquired = 0; /*!< number of acquired slots */
+};
+
+/*! key extractor calling given key function (resolved at compile time and inlined) */
+template<std::uint64_t (*Function)(const proc_pool&, int)>
+struct key_of
+{
+    std::uint64_t operator()(const proc_pool& pool, int slot) const {return Function(pool, slot);}
+};
+
+/*! key extractor calling key function given at runtime */
+struct runtime_key
+{
+    std::uint64_t (*function)(const proc_pool&, int); /*!< key function */
+
+    std::uint64_t operator()(const proc_pool& pool, int slot) const {return function(pool, slot);}
+};
+
+/*! binary heap of processes (pool slots) waiting for CPU, ordered by given compare function, same keys ordered by
+ *  arrival */
+template<typename Key>
+class basic_ready_queue
+{
+public:
+    explicit basic_ready_queue(const proc_pool& pool, Key key = Key()) : pool(pool), key(key) {}
+
+    /*! pushes process to the queue, its key is computed once (keys of waiting processes do not change) */
+    void push(int slot)
+    {
+        heap.push_back({key(pool, slot), pool[slot].seq, slot});
+        std::push_heap(heap.begin(), heap.end(), after);
+    }
+    /*! pops the first process from the queue */
+    int pop()
+    {
+        std::pop_heap(heap.begin(), heap.end(), after);
+        int slot = heap.back().slot;
+        heap.pop_back();
+        return slot;
+    }
+    bool empty() const {return heap.empty();}
+    std::size_t size() const {return heap.size();}
+    void reserve(std::size_t capacity) {heap.reserve(capacity);} /*!< preallocates heap (capacity hint) */
+    void save(snapshot_writer& snapshot) const {snapshot.put(heap);} /*!< writes heap to checkpoint */
+    void load(snapshot_reader& snapshot) {snapshot.get(heap);} /*!< reads heap from checkpoint */
+
+private:
+    /*! waiting process with its key stored inline, heap operations do not touch process records */
+    struct entry
+    {
+        std::uint64_t key; /*!< ordering key of process */
+        unsigned int seq; /*!< process arrival sequence number (orders same keys) */
+        int slot; /*!< process slot */
+    };
+
+    /*! checks if entry1 is scheduled after entry2 */
+    static bool after(const entry& entry1, const entry& entry2)
+    {
+        return entry1.key != entry2.key ? entry1.key > entry2.key : entry1.seq > entry2.seq;
+    }
+
+    std::vector<entry> heap; /*!< heap of waiting processes, first process on top */
+    const proc_pool& pool; /*!< pool of processes data */
+    Key key; /*!< key extractor */
+};
+
+/*! ready queue with key function given at runtime */
+using ready_queue = basic_ready_queue<runtime_key>;
+
+/*! ring buffer of processes (pool slots) waiting for CPU in Round Robin order */
+class rr_queue
+{
+public:
+    /*! pushes process to the end of the queue */
+    void push(int slot)
+    {
+        if(count == buffer.size()) grow();
+        buffer[(head + count++) & (buffer.size() - 1)] = slot;
+    }
+    /*! pops the first process from the queue */
+    int pop()
+    {
+        int slot = buffer[head];
+        head = (head + 1) & (buffer.size() - 1);
+        --count;
+        return slot;
+    }
+    bool empty() const {return count == 0;}
+    std::size_t size() const {return count;}
+    /*! preallocates buffer (capacity hint) */
+    void reserve(std::size_t capacity)
+    {
+        std::size_t size = buffer.empty() ? 16 : buffer.size();
+        while(size < capacity) size *= 2;
+        if(size != buffer.size()) resize(size);
+    }
+    /*! writes waiting processes (in queue order) to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put<std::uint64_t>(count);
+        for(std::size_t i = 0; i < count; ++i)
+            snapshot.put(buffer[(head + i) & (buffer.size() - 1)]);
+    }
+    /*! reads waiting processes from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        head = count = 0;
+        for(auto n = snapshot.get<std::uint64_t>(); n != 0; --n)
+            push(snapshot.get<int>());
+    }
+
+private:
+    /*! doubles buffer capacity (capacity is always power of 2) */
+    void grow() {resize(buffer.empty() ? 16 : buffer.size() * 2);}
+    /*! moves waiting processes to buffer of given capacity (power of 2) */
+    void resize(std::size_t size)
+    {
+        std::vector<int> grown(size);
+        for(std::size_t i = 0; i < count; ++i)
+            grown[i] = buffer[(head + i) & (buffer.size() - 1)];
+        buffer.swap(grown);
+        head = 0;
+    }
+
+    std::vector<int> buffer; /*!< waiting processes slots */
+    std::size_t head = 0; /*!< index of the first process */
+    std::size_t count = 0; /*!< number of waiting processes */
+};
+
+/*! hashed timer wheel of blocked processes (pool slots) waiting for the end of their I/O burst, wakeup less than
+ *  wheel_size ticks ahead is put to bucket of its time (O(1) push and wakeup), later wakeups wait in overflow heap,
+ *  bitmap of non-empty buckets finds the next wakeup, every wakeup time must be reached by the simulation (it is a
+ *  decision point) */
+class timer_wheel
+{
+public:
+    static constexpr std::size_t wheel_size = 1024; /*!< number of buckets (power of 2) */
+
+    timer_wheel() : buckets(wheel_size) {}
+
+    /*! blocks process until given wakeup time (later than now) */
+    void push(int slot, unsigned int wake_time, unsigned int now)
+    {
+        if(wake_time - now < wheel_size)
+        {
+            std::size_t bucket = wake_time & (wheel_size - 1);
+            buckets[bucket].push_back({wake_time, seq, slot});
+            nonempty[bucket / 64] |= std::uint64_t(1) << (bucket % 64);
+        }
+        else
+        {
+            overflow.push_back({wake_time, seq, slot});
+            std::push_heap(overflow.begin(), overflow.end(), after);
+        }
+        ++seq;
+        ++count;
+    }
+    /*! links processes which wakeup time has come at the end of proc_list (in order of blocking) */
+    void pop_due(proc_pool& proc_list, unsigned int now)
+    {
+        std::size_t bucket = now & (wheel_size - 1);
+        auto& due = buckets[bucket];
+        auto it = due.begin();
+        bool bucket_due = !due.empty() && due.front().wake_time <= now;
+        // bucket and overflow wakeups of the same time are merged by blocking sequence
+        for(auto end = bucket_due ? due.end() : due.begin(); it != end || overflow_due(now);)
+        {
+            if(it != end && (!overflow_due(now) || it->seq < overflow.front().seq))
+            {
+                proc_list.push_back(it++->slot);
+                continue;
+            }
+            std::pop_heap(overflow.begin(), overflow.end(), after);
+            proc_list.push_back(overflow.back().slot);
+            overflow.pop_back();
+            --count;
+        }
+        if(bucket_due)
+        {
+            count -= due.size();
+            due.clear();
+            nonempty[bucket / 64] &= ~(std::uint64_t(1) << (bucket % 64));
+        }
+        if(count == 0) seq = 0; // sequence numbers of blocking restart
+    }
+    /*! returns number of ticks until the next wakeup */
+    unsigned int ticks_to_wakeup(unsigned int now) const
+    {
+        unsigned int ticks = std::numeric_limits<unsigned int>::max();
+        if(!overflow.empty()) ticks = overflow.front().wake_time - now;
+        // the first non-empty bucket at or after bucket of now (wrapping around)
+        std::size_t start = now & (wheel_size - 1);
+        for(std::size_t i = 0; i <= words; ++i)
+        {
+            std::size_t word = (start / 64 + i) % words;
+            std::uint64_t bits = nonempty[word];
+            if(i == 0) bits &= ~std::uint64_t(0) << (start % 64);
+            else if(i == words) bits &= ~(~std::uint64_t(0) << (start % 64));
+            if(bits == 0) continue;
+            std::size_t bucket = word * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+            return std::min(ticks, static_cast<unsigned int>((bucket - start) & (wheel_size - 1)));
+        }
+        return ticks;
+    }
+    bool empty() const {return count == 0;}
+
+    /*! writes blocked processes to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(count);
+        snapshot.put(seq);
+        for(auto & bucket: buckets)
+            snapshot.put(bucket);
+        snapshot.put(overflow);
+    }
+    /*! reads blocked processes from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(count);
+        snapshot.get(seq);
+        for(std::size_t bucket = 0; bucket < wheel_size; ++bucket)
+        {
+            snapshot.get(buckets[bucket]);
+            if(buckets[bucket].empty()) nonempty[bucket / 64] &= ~(std::uint64_t(1) << (bucket % 64));
+            else nonempty[bucket / 64] |= std::uint64_t(1) << (bucket % 64);
+        }
+        snapshot.get(overflow);
+    }
+
+private:
+    static constexpr std::size_t words = wheel_size / 64; /*!< number of words of non-empty buckets bitmap */
+
+    /*! blocked process */
+    struct timer
+    {
+        unsigned int wake_time; /*!< time process wakes up */
+        std::size_t seq; /*!< blocking sequence number (orders same wakeup times in overflow heap) */
+        int slot; /*!< process slot */
+    };
+
+    /*! checks if the first overflow wakeup time has come */
+    bool overflow_due(unsigned int now) const {return !overflow.empty() && overflow.front().wake_time <= now;}
+    /*! checks if timer1 wakes up after timer2 */
+    static bool after(const timer& timer1, const timer& timer2)
+    {
+        return timer1.wake_time != timer2.wake_time ? timer1.wake_time > timer2.wake_time : timer1.seq > timer2.seq;
+    }
+    std::vector<std::vector<timer>> buckets; /*!< wakeups of every tick of the wheel */
+    std::uint64_t nonempty[words] = {}; /*!< bitmap of non-empty buckets */
+    std::vector<timer> overflow; /*!< heap of wakeups at least wheel_size ticks ahead of their blocking */
+    std::size_t count = 0; /*!< number of blocked processes */
+    std::size_t seq = 0; /*!< blocking sequence number of the next process */
+};
+
+/*! moves processes from slot to the end of proc_list to the queue */
+template<typename Queue>
+void enqueue(proc_pool& proc_list, int slot, Queue& queue)
+{
+    while(slot != -1)
+    {
+        int next = proc_list.next(slot);
+        proc_list.unlink(slot);
+        queue.push(slot);
+        slot = next;
+    }
+}
+
+/*! moves processes from slot to the end of proc_list to the queue, then fills proc_list with first processes of the
+ *  queue, one for every CPU (proc_list contains executing and arrived processes) */
+template<typename Queue>
+void dispatch(proc_pool& proc_list, int slot, Queue& queue, std::size_t cpu_count)
+{
+    enqueue(proc_list, slot, queue);
+    while(proc_list.size() < cpu_count && !queue.empty())
+        proc_list.push_back(queue.pop());
+}
+
+/*! returns first slot of proc_list after executing processes (they are at the beginning of proc_list) */
+int first_waiting(proc_pool& proc_list, std::vector<int>& cpus_slot)
+{
+    return cpus_slot.empty() ? proc_list.front() : proc_list.next(cpus_slot.back());
+}
+
+/*! puts scheduled processes on CPU/CPUS, slots of executing processes are stored in cpus_slot */
+void update_cpus_state(proc_pool& proc_list, std::vector<int>& cpus_slot, std::vector<int>& cpus_state)
+{
+    PROFILE_SCOPE(cpus_state);
+    cpus_slot.clear();
+    int slot = proc_list.front();
+    for(auto & cpu_state:cpus_state)
+    {
+        if(slot == -1)
+        {
+            cpu_state = -1;
+        }
+        else
+        {
+            cpu_state = proc_list[slot].id;
+            cpus_slot.push_back(slot);
+            slot = proc_list.next(slot);
+        }
+    }
+    /* sort processes on CPUS from lower to higher, negative numbers pushed at the end (-1 -> CPU sleep), states are
+     * sorted as unsigned keys with the same order (negative numbers from higher to lower after all ids) */
+    auto to_key = [](int state)
+    {
+        return state >= 0 ? static_cast<unsigned int>(state) : 0x80000000u + static_cast<unsigned int>(-1 - state);
+    };
+    for(auto & cpu_state: cpus_state)
+        cpu_state = static_cast<int>(to_key(cpu_state));
+    std::sort(cpus_state.begin(), cpus_state.end(), [](int i, int j)
+    {
+        return static_cast<unsigned int>(i) < static_cast<unsigned int>(j);
+    });
+    for(auto & cpu_state: cpus_state)
+        cpu_state = static_cast<int>(to_key(cpu_state));
+}
+
+/*! CPU affinity model, executing processes stay on their CPUS and switching CPU to another process costs time */
+struct cpu_affinity
+{
+    bool enabled = false; /*!< flag for CPU affinity mode (CPU states are printed per CPU, not sorted) */
+    unsigned int switch_cost = 0; /*!< ticks CPU needs to switch to another process (context switch) */
+    unsigned int migration_cost = 0; /*!< extra ticks when process was executed on another CPU before (migration) */
+    unsigned int round = 0; /*!< number of CPUS assignments */
+    std::vector<int> cpus_proc; /*!< proc_list slot of process on every CPU or -1 */
+    std::vector<int> cpus_last; /*!< id of the last process executed on every CPU or -1 */
+    std::vector<std::size_t> free_cpus; /*!< CPUS without process (temporary) */
+};
+
+/*! puts scheduled processes on CPUS incrementally, only CPUS which process has ended or was preempted get a new
+ *  process (preferably one that was executed on that CPU before), overwrites cpus_state with per CPU states */
+void place_on_cpus(proc_pool& proc_list, std::vector<int>& cpus_slot, std::vector<int>& cpus_state,
+                   cpu_affinity& affinity)
+{
+    if(affinity.cpus_proc.size() != cpus_state.size())
+    {
+        affinity.cpus_proc.assign(cpus_state.size(), -1);
+        affinity.cpus_last.assign(cpus_state.size(), -1);
+    }
+    ++affinity.round;
+    for(auto slot: cpus_slot)
+        proc_list[slot].round = affinity.round;
+    /* free CPUS which process has ended (slot released or reused) or was preempted */
+    affinity.free_cpus.clear();
+    for(std::size_t cpu = 0; cpu < cpus_state.size(); ++cpu)
+    {
+        int slot = affinity.cpus_proc[cpu];
+        if(slot != -1 && proc_list[slot].cpu == static_cast<int>(cpu) && proc_list[slot].round == affinity.round)
+        {
+            cpus_state[cpu] = proc_list[slot].id;
+            continue;
+        }
+        if(slot != -1 && proc_list[slot].cpu == static_cast<int>(cpu)) proc_list[slot].cpu = -1;
+        affinity.cpus_proc[cpu] = -1;
+        cpus_state[cpu] = -1;
+        affinity.free_cpus.push_back(cpu);
+    }
+    /* put newly scheduled processes on free CPUS */
+    auto it_cpu = affinity.free_cpus.begin();
+    for(auto slot: cpus_slot)
+    {
+        proc_data& pd = proc_list[slot];
+        if(pd.cpu != -1) continue;
+        std::size_t cpu;
+        if(pd.last_cpu != -1 && affinity.cpus_proc[static_cast<std::size_t>(pd.last_cpu)] == -1)
+            cpu = static_cast<std::size_t>(pd.last_cpu);
+        else
+        {
+            while(affinity.cpus_proc[*it_cpu] != -1) ++it_cpu;
+            cpu = *it_cpu;
+        }
+        unsigned int& switch_time = proc_list.switch_time(slot);
+        switch_time = 0;
+        if(affinity.cpus_last[cpu] != pd.id) switch_time += affinity.switch_cost;
+        if(pd.last_cpu != -1 && pd.last_cpu != static_cast<int>(cpu)) switch_time += affinity.migration_cost;
+        pd.cpu = pd.last_cpu = static_cast<int>(cpu);
+        affinity.cpus_proc[cpu] = slot;
+        affinity.cpus_last[cpu] = pd.id;
+        cpus_state[cpu] = pd.id;
+    }
+}
+
+/*! First Come First Serve scheduling algorithm */
+void fcfs(proc_pool& proc_list, std::vector<int>& cpus_slot, std::vector<int>& cpus_state)
+{
+    /* processes are already sorted */
+    update_cpus_state(proc_list, cpus_slot, cpus_state);
+}
+
+/*! Round Robin scheduling algorithm, expired is a temporary list kept by caller (no allocation per call) */
+void rr(proc_pool& proc_list, rr_queue& queue, std::vector<int>& cpus_slot, std::vector<int>& cpus_state,
+        unsigned int rr_time, std::vector<int>& expired)
+{
+    /* arrived processes are queued before processes which RR time slice has ended, woken processes start new slice */
+    for(int slot = first_waiting(proc_list, cpus_slot); slot != -1; slot = proc_list.next(slot))
+        proc_list.slice_time(slot) = 0;
+    /* processes executing without waiting processes were not stopped at slice ends, their slices started again */
+    for(auto slot: cpus_slot)
+        if(proc_list.slice_time(slot) > rr_time)
+            proc_list.slice_time(slot) = (proc_list.slice_time(slot) - 1) % rr_time + 1;
+    enqueue(proc_list, first_waiting(proc_list, cpus_slot), queue);
+    expired.clear(); // executing processes which RR time slice has ended
+    for(auto slot: cpus_slot)
+        if(proc_list.slice_time(slot) >= rr_time)
+            expired.push_back(slot);
+    /* push processes to the end of the queue (in order of CPUS states) and start their new time slice */
+    std::sort(expired.begin(), expired.end(), [&](int slot1, int slot2){return proc_list[slot1].id < proc_list[slot2].id;});
+    for(auto slot: expired)
+    {
+        proc_list.slice_time(slot) = 0;
+        proc_list.unlink(slot);
+        queue.push(slot);
+    }
+    dispatch(proc_list, -1, queue, cpus_state.size());
+    update_cpus_state(proc_list, cpus_slot, cpus_state);
+    /* time slice end without waiting processes does not change anything, it is not a decision point */
+    for(auto slot: cpus_slot)
+        proc_list[slot].quantum = queue.empty() ? 0 : rr_time;
+}
+
+/*! tournament tree selecting the first (lowest index) item with the smallest key, key of item is updated in O(log n) */
+class tournament_tree
+{
+public:
+    /*! builds tree of count items with keys given by key(index) */
+    template<typename Key>
+    void build(std::size_t count, Key key)
+    {
+        for(size = 1; size < count; size *= 2);
+        keys.assign(size, std::numeric_limits<std::uint64_t>::max()); // padding items never win
+        for(std::size_t i = 0; i < count; ++i)
+            keys[i] = key(i);
+        winners.resize(2 * size);
+        for(std::size_t i = 0; i < size; ++i)
+            winners[size + i] = i;
+        for(std::size_t node = size - 1; node >= 1; --node)
+            winners[node] = winner(winners[2 * node], winners[2 * node + 1]);
+    }
+    /*! changes key of item */
+    void update(std::size_t item, std::uint64_t key)
+    {
+        keys[item] = key;
+        for(std::size_t node = (size + item) / 2; node >= 1; node /= 2)
+            winners[node] = winner(winners[2 * node], winners[2 * node + 1]);
+    }
+    /*! returns the first item with the smallest key */
+    std::size_t first() const {return winners[1];}
+
+private:
+    /*! returns winner of items (item1 has lower index) */
+    std::size_t winner(std::size_t item1, std::size_t item2) const {return keys[item2] < keys[item1] ? item2 : item1;}
+
+    std::size_t size = 0; /*!< number of leaves (power of 2) */
+    std::vector<std::uint64_t> keys; /*!< key of every leaf */
+    std::vector<std::size_t> winners; /*!< winning item of every node (leaves from index size) */
+};
+
+/*! worker threads running loops over CPUS in parallel, CPUS are split into one contiguous range per thread (caller
+ *  thread runs the first one) and every loop ends with barrier, so results do not depend on timing of threads, waiting
+ *  workers spin (yielding) between loops */
+class parallel_cpus
+{
+public:
+    static constexpr std::size_t min_range = 256; /*!< minimal number of CPUS per thread, smaller loops run serially */
+
+    /*! starts thread_count - 1 worker threads */
+    explicit parallel_cpus(unsigned int thread_count)
+    {
+        for(unsigned int index = 1; index < thread_count; ++index)
+            threads.emplace_back([this, index](){work(index);});
+    }
+    ~parallel_cpus()
+    {
+        stop.store(true, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        for(auto & thread: threads)
+            thread.join();
+    }
+    parallel_cpus(const parallel_cpus&) = delete;
+    parallel_cpus& operator = (const parallel_cpus&) = delete;
+
+    /*! calls function(begin, end) for every range of [0, count) in parallel, returns when all ranges are done (function
+     *  must not throw) */
+    template<typename Function>
+    void for_ranges(std::size_t count, Function& function)
+    {
+        if(count < min_range * (threads.size() + 1))
+        {
+            function(0, count);
+            return;
+        }
+        task = [](void* context, std::size_t begin, std::size_t end){(*static_cast<Function*>(context))(begin, end);};
+        context = &function;
+        size = count;
+        pending.store(threads.size(), std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        function(0, range_begin(1));
+        for(unsigned int spins = 0; pending.load(std::memory_order_acquire) != 0; ++spins)
+            if(spins > max_spins) std::this_thread::yield();
+    }
+
+private:
+    static constexpr unsigned int max_spins = 1 << 12; /*!< busy waiting iterations before yielding */
+
+    /*! returns the first CPU of range of thread */
+    std::size_t range_begin(std::size_t index) const {return size * index / (threads.size() + 1);}
+    /*! runs range of thread in every loop until workers are stopped */
+    void work(std::size_t index)
+    {
+        for(unsigned int seen = 0;;)
+        {
+            unsigned int current;
+            for(unsigned int spins = 0; (current = generation.load(std::memory_order_acquire)) == seen; ++spins)
+                if(spins > max_spins) std::this_thread::yield();
+            seen = current;
+            if(stop.load(std::memory_order_relaxed)) return;
+            task(context, range_begin(index), range_begin(index + 1));
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    std::vector<std::thread> threads; /*!< worker threads */
+    void (*task)(void*, std::size_t, std::size_t) = nullptr; /*!< calls function of current loop */
+    void* context = nullptr; /*!< function of current loop */
+    std::size_t size = 0; /*!< number of CPUS of current loop */
+    std::atomic<unsigned int> generation{0}; /*!< number of started loops */
+    std::atomic<std::size_t> pending{0}; /*!< number of workers running current loop */
+    std::atomic<bool> stop{false}; /*!< flag for stopping workers */
+};
+
+/*! per CPU run queues of multi-queue scheduling algorithm */
+struct multi_queue_state
+{
+    multi_queue_state(const proc_pool& pool, std::size_t cpu_count, unsigned int local_method)
+        : running(cpu_count, -1), srtf(local_method == 2)
+    {
+        auto key = srtf ? proc_pool::key_remaining_time : proc_pool::key_arrival;
+        queues.reserve(cpu_count);
+        for(std::size_t cpu = 0; cpu < cpu_count; ++cpu)
+            queues.emplace_back(pool, runtime_key{key});
+    }
+
+    /*! writes executing processes and queues to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(running);
+        for(auto & queue: queues)
+            queue.save(snapshot);
+    }
+    /*! reads executing processes and queues from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        std::size_t cpu_count = running.size();
+        snapshot.get(running);
+        if(running.size() != cpu_count) throw std::invalid_argument("invalid checkpoint (number of CPUS)");
+        for(auto & queue: queues)
+            queue.load(snapshot);
+    }
+
+    std::vector<int> running; /*!< proc_list slot of process executing on every CPU or -1 */
+    std::vector<ready_queue> queues; /*!< processes waiting for every CPU */
+    bool srtf; /*!< local queues are scheduled using SRTF (otherwise FCFS) */
+    unsigned int steal_threshold = 1; /*!< minimal number of waiting processes of CPU that other CPU steals from */
+    unsigned int migration_cost = 0; /*!< ticks stolen process needs to migrate to another CPU */
+    tournament_tree loads; /*!< CPUS by load, least loaded first (temporary) */
+    std::unique_ptr<parallel_cpus> workers; /*!< threads scheduling local queues in parallel or null */
+};
+
+/*! Multi-queue scheduling algorithm, every CPU has its own queue (FCFS or SRTF), arrived processes are put to the least
+ *  loaded CPU and idle CPUS steal waiting processes from the most loaded CPU, CPU states are printed per CPU */
+void multi_queue(proc_pool& proc_list, multi_queue_state& mq, std::vector<int>& cpus_slot,
+                 std::vector<int>& cpus_state)
+{
+    std::size_t cpu_count = cpus_state.size();
+    /* executing processes are moved out of proc_list, ended processes are dropped */
+    int arrived = first_waiting(proc_list, cpus_slot);
+    for(auto slot: cpus_slot)
+        proc_list.unlink(slot);
+    for(std::size_t cpu = 0; cpu < cpu_count; ++cpu)
+    {
+        int slot = mq.running[cpu];
+        if(slot != -1 && (proc_list[slot].cpu != static_cast<int>(cpu) || proc_list.remaining_time(slot) == 0))
+            mq.running[cpu] = -1;
+    }
+    auto load = [&](std::size_t cpu){return mq.queues[cpu].size() + (mq.running[cpu] != -1);};
+    /* put arrived processes to the least loaded CPUS (the first one of same loads) */
+    if(arrived != -1) mq.loads.build(cpu_count, load);
+    while(arrived != -1)
+    {
+        int next = proc_list.next(arrived);
+        proc_list.unlink(arrived);
+        std::size_t target = mq.loads.first();
+        proc_list[arrived].cpu = -1;
+        mq.queues[target].push(arrived);
+        mq.loads.update(target, load(target));
+        arrived = next;
+    }
+    /* schedule local queues (CPUS are independent, in parallel if there are workers) */
+    auto schedule_local = [&](std::size_t begin, std::size_t end)
+    {
+        for(std::size_t cpu = begin; cpu < end; ++cpu)
+        {
+            int& slot = mq.running[cpu];
+            if(slot != -1 && mq.srtf)
+            {
+                // executing process competes with waiting processes
+                mq.queues[cpu].push(slot);
+                int first = mq.queues[cpu].pop();
+                if(first != slot)
+                {
+                    proc_list[slot].cpu = -1;
+                    proc_list.switch_time(first) = 0;
+                    slot = first;
+                }
+            }
+            if(slot == -1 && !mq.queues[cpu].empty())
+            {
+                slot = mq.queues[cpu].pop();
+                proc_list.switch_time(slot) = 0;
+            }
+        }
+    };
+    if(mq.workers != nullptr) mq.workers->for_ranges(cpu_count, schedule_local);
+    else schedule_local(0, cpu_count);
+    /* idle CPUS steal waiting processes from the most loaded CPU (the first one of same numbers of waiting processes) */
+    auto waiting = [&](std::size_t cpu){return ~static_cast<std::uint64_t>(mq.queues[cpu].size());}; // most first
+    bool stealing = false; // CPUS are ordered by waiting processes
+    for(std::size_t cpu = 0; cpu < cpu_count; ++cpu)
+    {
+        if(mq.running[cpu] != -1) continue;
+        if(!stealing) mq.loads.build(cpu_count, waiting);
+        stealing = true;
+        std::size_t victim = mq.loads.first();
+        // no CPU has enough waiting processes to steal from
+        if(mq.queues[victim].empty() || mq.queues[victim].size() < mq.steal_threshold) break;
+        int slot = mq.queues[victim].pop();
+        mq.loads.update(victim, waiting(victim));
+        proc_list.switch_time(slot) = mq.migration_cost;
+        mq.running[cpu] = slot;
+    }
+    /* executing processes are put back to proc_list in order of CPUS */
+    cpus_slot.clear();
+    for(std::size_t cpu = 0; cpu < cpu_count; ++cpu)
+    {
+        int slot = mq.running[cpu];
+        cpus_state[cpu] = slot == -1 ? -1 : proc_list[slot].id;
+        if(slot == -1) continue;
+        proc_list[slot].cpu = static_cast<int>(cpu);
+        proc_list.push_back(slot);
+        cpus_slot.push_back(slot);
+    }
+}
+
+/*! levels of multi-level feedback queue scheduling algorithm */
+class mlfq_state
+{
+public:
+    static constexpr std::size_t max_levels = 64; /*!< maximal number of levels (bits of non-empty levels bitmap) */
+
+    /*! creates levels with given time quantum, boost is a period of moving all processes to the first level (0 - off) */
+    mlfq_state(std::vector<unsigned int> quanta, unsigned int boost) : quanta(std::move(quanta)), boost(boost)
+    {
+        if(this->quanta.empty() || this->quanta.size() > max_levels)
+            throw std::invalid_argument("invalid number of MLFQ levels");
+        if(std::find(this->quanta.begin(), this->quanta.end(), 0u) != this->quanta.end())
+            throw std::invalid_argument("invalid MLFQ time quantum");
+        levels.resize(this->quanta.size());
+        next_boost = boost;
+    }
+
+    /*! pushes process to the end of its level */
+    void push(proc_pool& proc_list, int slot)
+    {
+        unsigned int level = proc_list[slot].level;
+        proc_list[slot].quantum = quanta[level];
+        levels[level].push(slot);
+        nonempty |= std::uint64_t(1) << level;
+    }
+    /*! pops the first process of the highest non-empty level */
+    int pop()
+    {
+        unsigned int level = first_level();
+        int slot = levels[level].pop();
+        if(levels[level].empty()) nonempty &= ~(std::uint64_t(1) << level);
+        return slot;
+    }
+    bool empty() const {return nonempty == 0;}
+    /*! returns the highest non-empty level (lower number - higher priority) */
+    unsigned int first_level() const {return static_cast<unsigned int>(__builtin_ctzll(nonempty));}
+    unsigned int last_level() const {return static_cast<unsigned int>(quanta.size() - 1);}
+    unsigned int quantum(unsigned int level) const {return quanta[level];} /*!< time quantum of level */
+    /*! returns used part of time quantum of process, process on the last level without waiting processes is not
+     *  stopped at its quantum ends (its quantum starts again) */
+    unsigned int used_slice(const proc_pool& proc_list, int slot) const
+    {
+        unsigned int quantum = quanta[proc_list[slot].level];
+        unsigned int slice_time = proc_list.slice_time(slot);
+        return slice_time > quantum ? (slice_time - 1) % quantum + 1 : slice_time;
+    }
+
+    /*! checks if processes are boosted at given time, returns ticks until the next boost */
+    bool boost_due(unsigned int time) const {return boost != 0 && time >= next_boost;}
+    unsigned int ticks_to_boost(unsigned int time) const
+    {
+        return boost == 0 ? std::numeric_limits<unsigned int>::max() : next_boost - time;
+    }
+    /*! moves all waiting processes to the first level */
+    void boost_all(proc_pool& proc_list, unsigned int time)
+    {
+        for(std::size_t level = 1; level < levels.size(); ++level)
+        {
+            while(!levels[level].empty())
+            {
+                int slot = levels[level].pop();
+                proc_list[slot].level = 0;
+                proc_list.slice_time(slot) = 0;
+                push(proc_list, slot);
+            }
+        }
+        nonempty &= 1;
+        next_boost = (time / boost + 1) * boost;
+    }
+
+    /*! writes levels to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(nonempty);
+        snapshot.put(next_boost);
+        for(auto & level: levels)
+            level.save(snapshot);
+    }
+    /*! reads levels from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(nonempty);
+        snapshot.get(next_boost);
+        for(auto & level: levels)
+            level.load(snapshot);
+    }
+
+private:
+    std::vector<unsigned int> quanta; /*!< time quantum of every level */
+    std::vector<rr_queue> levels; /*!< processes waiting on every level */
+    std::uint64_t nonempty = 0; /*!< bitmap of non-empty levels */
+    unsigned int boost; /*!< period of priority boost (0 - off) */
+    unsigned int next_boost; /*!< time of the next priority boost */
+};
+
+/*! Multi-level feedback queue scheduling algorithm, arrived processes start on the first level, process that uses its
+ *  time quantum is moved one level down (process blocked for I/O stays on its level), processes of higher levels preempt
+ *  processes of lower levels, same levels are scheduled using RR, all processes are periodically boosted to the first
+ *  level */
+void mlfq(proc_pool& proc_list, mlfq_state& levels, std::vector<int>& cpus_slot, std::vector<int>& cpus_state,
+          unsigned int time, std::vector<int>& rotated)
+{
+    /* arrived processes start on the first level, woken processes keep their level and used part of its quantum */
+    for(int slot = first_waiting(proc_list, cpus_slot); slot != -1;)
+    {
+        int next = proc_list.next(slot);
+        proc_list.unlink(slot);
+        proc_data& pd = proc_list[slot];
+        unsigned int& slice_time = proc_list.slice_time(slot);
+        if(proc_list.remaining_time(slot) == pd.exec_time)
+        {
+            pd.level = 0;
+            slice_time = 0;
+        }
+        else if((slice_time = levels.used_slice(proc_list, slot)) >= levels.quantum(pd.level))
+        {
+            // process blocked when its time quantum ended
+            pd.level = std::min(pd.level + 1, levels.last_level());
+            slice_time = 0;
+        }
+        levels.push(proc_list, slot);
+        slot = next;
+    }
+    /* processes executing on the last level without waiting processes were not stopped at their quantum ends, they are
+     * moved to the end of executing processes as if they were stopped, in order of their last quantum end, processes
+     * which quantum ended together in order of their first quantum end since the last decision point */
+    rotated.clear();
+    for(auto slot: cpus_slot)
+        if(proc_list.slice_time(slot) > levels.quantum(proc_list[slot].level))
+            rotated.push_back(slot);
+    std::stable_sort(rotated.begin(), rotated.end(), [&](int slot1, int slot2)
+    {
+        unsigned int used1 = levels.used_slice(proc_list, slot1);
+        unsigned int used2 = levels.used_slice(proc_list, slot2);
+        if(used1 != used2) return used1 > used2;
+        return proc_list.slice_time(slot1) < proc_list.slice_time(slot2);
+    });
+    for(auto slot: rotated)
+    {
+        proc_list.slice_time(slot) = levels.used_slice(proc_list, slot);
+        proc_list.unlink(slot);
+        proc_list.push_back(slot);
+    }
+    /* boost all processes to the first level */
+    bool boost = levels.boost_due(time);
+    if(boost) levels.boost_all(proc_list, time);
+    /* executing processes which used their time quantum are moved one level down */
+    for(int slot = proc_list.front(), next; slot != -1; slot = next)
+    {
+        proc_data& pd = proc_list[slot];
+        next = proc_list.next(slot);
+        if(boost) pd.level = 0;
+        else if(proc_list.slice_time(slot) < levels.quantum(pd.level)) continue;
+        else pd.level = std::min(pd.level + 1, levels.last_level());
+        proc_list.slice_time(slot) = 0;
+        proc_list.unlink(slot);
+        levels.push(proc_list, slot);
+    }
+    /* idle CPUS take processes of the highest levels */
+    while(proc_list.size() < cpus_state.size() && !levels.empty())
+        proc_list.push_back(levels.pop());
+    /* waiting processes of higher levels preempt executing processes of the lowest level */
+    while(!levels.empty())
+    {
+        int lowest = proc_list.front();
+        for(int slot = proc_list.front(); slot != -1; slot = proc_list.next(slot))
+            if(proc_list[slot].level >= proc_list[lowest].level) lowest = slot;
+        if(lowest == -1 || levels.first_level() >= proc_list[lowest].level) break;
+        proc_list.unlink(lowest);
+        proc_list.push_back(levels.pop());
+        levels.push(proc_list, lowest);
+    }
+    update_cpus_state(proc_list, cpus_slot, cpus_state);
+    /* time slice end of the last level without waiting processes does not change anything, it is not a decision point */
+    for(auto slot: cpus_slot)
+        proc_list[slot].quantum = levels.empty() && proc_list[slot].level == levels.last_level()
+                                  ? 0 : levels.quantum(proc_list[slot].level);
+}
+
+/*! waiting processes of fair scheduling algorithm ordered by virtual runtime */
+class fair_state
+{
+public:
+    /*! creates empty tree, executing process can't be preempted before it executes min_granularity ticks */
+    explicit fair_state(unsigned int min_granularity) : min_granularity(min_granularity)
+    {
+        if(min_granularity == 0) throw std::invalid_argument("invalid minimal granularity");
+    }
+
+    /*! returns virtual runtime gained by process in one tick, lower the priority number bigger the weight */
+    static std::uint64_t tick_cost(const proc_data& pd) {return static_cast<std::uint64_t>(std::max(pd.priority, 0)) + 1;}
+    /*! returns virtual runtime of process including its current time slice */
+    static std::uint64_t vruntime(const proc_pool& proc_list, int slot)
+    {
+        const proc_data& pd = proc_list[slot];
+        return pd.vruntime + proc_list.slice_time(slot) * tick_cost(pd);
+    }
+
+    /*! adds process to the tree, its current time slice is accounted to its virtual runtime */
+    void push(proc_pool& proc_list, int slot)
+    {
+        proc_data& pd = proc_list[slot];
+        pd.vruntime = vruntime(proc_list, slot);
+        proc_list.slice_time(slot) = 0;
+        pd.quantum = 0;
+        tree.insert({pd.vruntime, pd.seq, slot});
+    }
+    /*! removes process with the smallest virtual runtime from the tree */
+    int pop()
+    {
+        int slot = tree.begin()->slot;
+        tree.erase(tree.begin());
+        return slot;
+    }
+    bool empty() const {return tree.empty();}
+    void reserve(std::size_t capacity) {arena.reserve(capacity);} /*!< preallocates tree nodes (capacity hint) */
+    /*! returns the smallest virtual runtime of waiting processes */
+    std::uint64_t first_vruntime() const {return tree.begin()->vruntime;}
+    /*! writes waiting processes to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(min_vruntime);
+        snapshot.put<std::uint64_t>(tree.size());
+        for(auto & key: tree)
+            snapshot.put(key);
+    }
+    /*! reads waiting processes from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(min_vruntime);
+        tree.clear();
+        for(auto n = snapshot.get<std::uint64_t>(); n != 0; --n)
+            tree.emplace_hint(tree.end(), snapshot.get<fair_key>());
+    }
+
+    std::uint64_t min_vruntime = 0; /*!< monotonic minimum of virtual runtime, arrived processes start with it */
+    unsigned int min_granularity; /*!< minimal number of ticks process executes before it is preempted */
+
+private:
+    /*! key of waiting process, same virtual runtimes are ordered by arrival */
+    struct fair_key
+    {
+        std::uint64_t vruntime; /*!< virtual runtime of process */
+        unsigned int seq; /*!< process arrival sequence number */
+        int slot; /*!< process slot */
+
+        bool operator<(const fair_key& other) const
+        {
+            return vruntime != other.vruntime ? vruntime < other.vruntime : seq < other.seq;
+        }
+    };
+
+    block_arena arena; /*!< nodes of tree */
+    std::set<fair_key, std::less<fair_key>, arena_allocator<fair_key>> tree{std::less<fair_key>(),
+        arena_allocator<fair_key>(&arena)}; /*!< waiting processes (red-black tree) */
+};
+
+/*! Fair scheduling algorithm (CFS-like), process with the smallest weighted virtual runtime is executed, executing
+ *  process is preempted by waiting process with smaller virtual runtime after it executes minimal granularity ticks */
+void fair(proc_pool& proc_list, fair_state& fs, std::vector<int>& cpus_slot, std::vector<int>& cpus_state)
+{
+    /* update minimal virtual runtime */
+    std::uint64_t min_vruntime = std::numeric_limits<std::uint64_t>::max();
+    for(auto slot: cpus_slot)
+        min_vruntime = std::min(min_vruntime, fair_state::vruntime(proc_list, slot));
+    if(!fs.empty()) min_vruntime = std::min(min_vruntime, fs.first_vruntime());
+    if(min_vruntime != std::numeric_limits<std::uint64_t>::max()) fs.min_vruntime = std::max(fs.min_vruntime, min_vruntime);
+    /* arrived processes start with minimal virtual runtime, woken processes keep bigger virtual runtime */
+    for(int slot = first_waiting(proc_list, cpus_slot); slot != -1;)
+    {
+        int next = proc_list.next(slot);
+        proc_list.unlink(slot);
+        proc_list[slot].vruntime = std::max(fair_state::vruntime(proc_list, slot), fs.min_vruntime);
+        proc_list.slice_time(slot) = 0;
+        fs.push(proc_list, slot);
+        slot = next;
+    }
+    /* idle CPUS take processes with the smallest virtual runtime */
+    while(proc_list.size() < cpus_state.size() && !fs.empty())
+        proc_list.push_back(fs.pop());
+    /* waiting process preempts executing process with the biggest virtual runtime which executed minimal granularity */
+    while(!fs.empty())
+    {
+        int preempted = -1;
+        for(int slot = proc_list.front(); slot != -1; slot = proc_list.next(slot))
+        {
+            if(proc_list.slice_time(slot) < fs.min_granularity) continue;
+            if(preempted == -1 || fair_state::vruntime(proc_list, slot) >= fair_state::vruntime(proc_list, preempted))
+                preempted = slot;
+        }
+        if(preempted == -1 || fair_state::vruntime(proc_list, preempted) <= fs.first_vruntime()) break;
+        proc_list.unlink(preempted);
+        proc_list.push_back(fs.pop());
+        fs.push(proc_list, preempted);
+    }
+    /* time slice of executing process ends when its virtual runtime exceeds the smallest waiting one, without waiting
+     * processes the last tick of CPU burst is a decision point (minimal virtual runtime accounts executing processes
+     * before they end their CPU bursts, as if it was updated in every tick) */
+    for(int slot = proc_list.front(); slot != -1; slot = proc_list.next(slot))
+    {
+        proc_data& pd = proc_list[slot];
+        pd.quantum = 0;
+        if(fs.empty())
+        {
+            unsigned int left = proc_list.remaining_time(slot);
+            if(pd.burst_time != 0) left = std::min(left, proc_list.burst_left(slot));
+            std::uint64_t slice_time = proc_list.slice_time(slot);
+            if(left > 1)
+                pd.quantum = static_cast<unsigned int>(std::min<std::uint64_t>(slice_time + left - 1,
+                                                                               std::numeric_limits<unsigned int>::max() / 2));
+            continue;
+        }
+        std::uint64_t slice = fs.first_vruntime() < pd.vruntime ? 0 : (fs.first_vruntime() - pd.vruntime) / fair_state::tick_cost(pd) + 1;
+        pd.quantum = static_cast<unsigned int>(std::min<std::uint64_t>(std::max<std::uint64_t>(slice, fs.min_granularity),
+                                                                       std::numeric_limits<unsigned int>::max() / 2));
+    }
+    update_cpus_state(proc_list, cpus_slot, cpus_state);
+}
+
+/*! checks if all CPUS are sleeping (==-1) */
+bool all_cpus_sleeping(std::vector<int>& cpus_state)
+{
+    if(std::any_of(cpus_state.begin(), cpus_state.end(), [](int i){return i != -1;}))
+        return false;
+    return true;
+}
+
+/* Binary trace format:
+ * header -> "PSTR" magic, version byte, 3 reserved bytes
+ * record -> one record per input line: time delta, number of processes, for every process: id delta, priority,
+ *           exec_t * 2 + flag of bursts, then burst and io if flag is set
+ * Numbers are LEB128 varints, deltas (from previous record time and previous process id) and priorities are zigzag
+ * encoded. Trace ends with the end of file. Version 1 traces (exec_t without flag, no bursts) are read too.
+ */
+constexpr char trace_magic[4] = {'P', 'S', 'T', 'R'}; /*!< binary trace magic */
+constexpr unsigned char trace_version = 2; /*!< binary trace format version */
+constexpr std::size_t binary_header_size = 8; /*!< binary trace (and binary changes) header size */
+constexpr std::size_t max_varint_length = 10; /*!< maximal length of encoded 64 bit varint */
+
+/*! maps signed number to unsigned one, numbers with small absolute value are mapped to small numbers */
+std::uint64_t zigzag_encode(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+/*! inverse of zigzag_encode */
+std::int64_t zigzag_decode(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/*! encodes varint to bytes, returns number of bytes */
+std::size_t encode_varint(std::uint64_t value, char* bytes)
+{
+    std::size_t count = 0;
+    for(; value >= 0x80; value >>= 7)
+        bytes[count++] = static_cast<char>((value & 0x7f) | 0x80);
+    bytes[count++] = static_cast<char>(value);
+    return count;
+}
+
+/*! decodes varint from [it, end), returns number of bytes (0 if varint is truncated) */
+std::size_t decode_varint(const char* it, const char* end, std::uint64_t& value)
+{
+    value = 0;
+    for(std::size_t count = 0; it + count != end && count < max_varint_length; ++count)
+    {
+        auto byte = static_cast<unsigned char>(it[count]);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * count);
+        if((byte & 0x80) == 0) return count + 1;
+    }
+    return 0;
+}
+
+/*! input parser, reads input in large blocks (or maps input file to memory) and parses lines in place without
+ *  allocations */
+class input_parser
+{
+public:
+    explicit input_parser(std::FILE* file, std::size_t block_size = 1 << 20) : file(file), buffer(block_size)
+    {
+        data = buffer.data();
+    }
+    /*! maps given input file to memory, whole input is parsed directly from the mapping */
+    explicit input_parser(const char* path)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0) throw std::invalid_argument("cannot open input file");
+        struct stat st{};
+        if(::fstat(fd, &st) < 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("cannot stat input file");
+        }
+        len = static_cast<std::size_t>(st.st_size);
+        eof = true;
+        if(len != 0)
+        {
+            mapping = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapping == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("cannot map input file");
+            }
+            data = static_cast<const char*>(mapping);
+            ::madvise(mapping, len, MADV_SEQUENTIAL);
+            read_ahead();
+        }
+        ::close(fd);
+    }
+    ~input_parser()
+    {
+        if(mapping != nullptr) ::munmap(mapping, len);
+    }
+    input_parser(const input_parser&) = delete;
+    input_parser& operator = (const input_parser&) = delete;
+
+    /*! parses one input line (or binary trace record), returns false if there is no input remaining (empty line) */
+    bool read(unsigned int& time, std::vector<proc_data>& arrivals, unsigned int& seq)
+    {
+        PROFILE_SCOPE(parse);
+        if(!format_detected) detect_format();
+        if(binary) return read_record(time, arrivals, seq);
+        const char* it;
+        const char* end;
+        if(!next_line(it, end) || !parse_number(it, end, time)) return false;
+        proc_data pd{};
+        while(parse_number(it, end, pd.id))
+        {
+            if(!parse_number(it, end, pd.priority) || !parse_number(it, end, pd.exec_time))
+                throw std::invalid_argument("invalid input line (incomplete process data)");
+            pd.burst_time = pd.io_time = 0;
+            if(it != end && *it == '/')
+            {
+                // CPU bursts separated by I/O bursts (exec_t/burst/io)
+                if(!parse_number(++it, end, pd.burst_time) || it == end || *it != '/' || !parse_number(++it, end, pd.io_time))
+                    throw std::invalid_argument("invalid input line (incomplete burst times)");
+                // only repeating pattern of one CPU burst and one I/O burst is modelled, lists of bursts are rejected
+                if(it != end && *it == '/')
+                    throw std::invalid_argument("invalid input line (burst list, only exec_time/burst/io is supported)");
+                check_bursts(pd);
+            }
+            pd.seq = seq++;
+            arrivals.push_back(pd);
+        }
+        return true;
+    }
+
+    /*! writes input position and decoding state to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put<std::uint64_t>(consumed + pos);
+        snapshot.put(format_detected);
+        snapshot.put(binary);
+        snapshot.put(bursts);
+        snapshot.put(record_time);
+        snapshot.put(record_id);
+    }
+    /*! reads input position from checkpoint and skips input before it (input must be the checkpointed one), called
+     *  before the first read */
+    void load(snapshot_reader& snapshot)
+    {
+        auto offset = snapshot.get<std::uint64_t>();
+        snapshot.get(format_detected);
+        snapshot.get(binary);
+        snapshot.get(bursts);
+        snapshot.get(record_time);
+        snapshot.get(record_id);
+        skip(offset);
+    }
+
+private:
+    static constexpr std::size_t read_ahead_size = 16 << 20; /*!< size of mapping prefetched ahead of parsing */
+
+    /*! skips input before given offset, seekable input file is seeked, other input is read and dropped */
+    void skip(std::uint64_t offset)
+    {
+        if(file == nullptr)
+        {
+            // mapped input file
+            if(offset > len) throw std::invalid_argument("input is shorter than checkpointed input");
+            pos = static_cast<std::size_t>(offset);
+            if(mapping != nullptr) read_ahead();
+            return;
+        }
+        struct stat st{};
+        if(::fstat(::fileno(file), &st) == 0 && S_ISREG(st.st_mode) && static_cast<std::uint64_t>(st.st_size) < offset)
+            throw std::invalid_argument("input is shorter than checkpointed input");
+        if(::fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0)
+        {
+            consumed = offset;
+            return;
+        }
+        while(consumed + len < offset && !eof)
+        {
+            pos = len;
+            refill();
+        }
+        if(consumed + len < offset) throw std::invalid_argument("input is shorter than checkpointed input");
+        pos = static_cast<std::size_t>(offset - consumed);
+    }
+
+    /*! checks if input is a binary trace (starts with binary trace header) */
+    void detect_format()
+    {
+        format_detected = true;
+        if(ensure(binary_header_size) < binary_header_size || std::memcmp(data + pos, trace_magic, sizeof(trace_magic)) != 0)
+            return;
+        auto version = static_cast<unsigned char>(data[pos + sizeof(trace_magic)]);
+        if(version != trace_version && version != 1) throw std::invalid_argument("unsupported binary trace version");
+        binary = true;
+        bursts = version != 1;
+        pos += binary_header_size;
+    }
+
+    /*! decodes one binary trace record, returns false at the end of trace */
+    bool read_record(unsigned int& time, std::vector<proc_data>& arrivals, unsigned int& seq)
+    {
+        if(ensure(1) == 0) return false;
+        time = static_cast<unsigned int>(static_cast<std::int64_t>(record_time) + zigzag_decode(read_varint()));
+        record_time = time;
+        proc_data pd{};
+        for(std::uint64_t count = read_varint(); count != 0; --count)
+        {
+            pd.id = static_cast<int>(record_id + zigzag_decode(read_varint()));
+            pd.priority = static_cast<int>(zigzag_decode(read_varint()));
+            std::uint64_t exec_time = read_varint();
+            pd.exec_time = static_cast<unsigned int>(bursts ? exec_time >> 1 : exec_time);
+            pd.burst_time = pd.io_time = 0;
+            if(bursts && (exec_time & 1) != 0)
+            {
+                pd.burst_time = static_cast<unsigned int>(read_varint());
+                pd.io_time = static_cast<unsigned int>(read_varint());
+                check_bursts(pd);
+            }
+            pd.seq = seq++;
+            record_id = pd.id;
+            arrivals.push_back(pd);
+        }
+        if(mapping != nullptr && pos >= read_ahead_pos) read_ahead();
+        return true;
+    }
+
+    /*! checks burst times of process (CPU and I/O bursts are not empty) */
+    static void check_bursts(const proc_data& pd)
+    {
+        if(pd.burst_time == 0 || pd.io_time == 0) throw std::invalid_argument("invalid input line (burst times)");
+    }
+
+    /*! decodes next varint of binary trace */
+    std::uint64_t read_varint()
+    {
+        ensure(max_varint_length);
+        std::uint64_t value;
+        std::size_t count = decode_varint(data + pos, data + len, value);
+        if(count == 0) throw std::invalid_argument("invalid binary trace (truncated record)");
+        pos += count;
+        return value;
+    }
+
+    /*! reads blocks until at least count bytes are available (or input ended), returns number of available bytes */
+    std::size_t ensure(std::size_t count)
+    {
+        while(len - pos < count && !eof) refill();
+        return len - pos;
+    }
+
+    /*! moves not parsed input to the beginning of buffer and reads next block */
+    void refill()
+    {
+        consumed += pos;
+        std::memmove(buffer.data(), buffer.data() + pos, len - pos);
+        len -= pos;
+        pos = 0;
+        if(len == buffer.size()) buffer.resize(buffer.size() * 2);
+        data = buffer.data();
+        std::size_t count = std::fread(buffer.data() + len, 1, buffer.size() - len, file);
+        len += count;
+        if(count == 0) eof = true;
+    }
+
+    /*! finds next line in buffer, reads next block if line is not complete, returns false at the end of input */
+    bool next_line(const char*& begin, const char*& end)
+    {
+        while(true)
+        {
+            auto newline = static_cast<const char*>(std::memchr(data + pos, '\n', len - pos));
+            if(newline != nullptr || (eof && pos != len))
+            {
+                begin = data + pos;
+                end = newline != nullptr ? newline : data + len;
+                pos = static_cast<std::size_t>(end - data) + (newline != nullptr);
+                if(mapping != nullptr && pos >= read_ahead_pos) read_ahead();
+                return true;
+            }
+            if(eof) return false;
+            // line is not complete
+            refill();
+        }
+    }
+
+    /*! advises kernel to read next part of the mapping ahead of parsing */
+    void read_ahead()
+    {
+        const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t begin = pos / page * page;
+        std::size_t size = std::min(read_ahead_size, len - begin);
+        ::madvise(static_cast<char*>(mapping) + begin, size, MADV_WILLNEED);
+        read_ahead_pos = begin + size / 2;
+    }
+
+    /*! parses next number of line, returns false if there is no number remaining */
+    template<typename T>
+    static bool parse_number(const char*& it, const char* end, T& value)
+    {
+        while(it != end && (*it == ' ' || *it == '\t' || *it == '\r')) ++it;
+        if(it == end) return false;
+        auto result = std::from_chars(it, end, value);
+        if(result.ec != std::errc()) throw std::invalid_argument("invalid input line (not a number)");
+        it = result.ptr;
+        return true;
+    }
+
+    std::FILE* file = nullptr; /*!< input file (block mode) */
+    std::vector<char> buffer; /*!< input block (block mode) */
+    void* mapping = nullptr; /*!< memory mapped input file (mapped mode) */
+    const char* data = nullptr; /*!< input data (block or mapping) */
+    std::size_t pos = 0; /*!< beginning of not parsed input in data */
+    std::size_t len = 0; /*!< end of input in data */
+    std::size_t read_ahead_pos = 0; /*!< position of data that triggers next read ahead (mapped mode) */
+    std::uint64_t consumed = 0; /*!< input bytes before the beginning of data (block mode) */
+    bool eof = false; /*!< flag for end of input file */
+    bool format_detected = false; /*!< flag for detected input format */
+    bool binary = false; /*!< flag for binary trace input */
+    bool bursts = false; /*!< flag for binary trace with burst times (version 2) */
+    unsigned int record_time = 0; /*!< time of previous binary trace record */
+    int record_id = 0; /*!< id of previous process of binary trace */
+};
+
+/*! writes position of input to checkpoint, checkpoints are supported only for input parser */
+template<typename Reader>
+void save_input(snapshot_writer&, const Reader&)
+{
+    throw std::invalid_argument("checkpoint of this input is not supported");
+}
+void save_input(snapshot_writer& snapshot, const input_parser& parser)
+{
+    parser.save(snapshot);
+}
+
+/*! reads position of input from checkpoint */
+template<typename Reader>
+void load_input(snapshot_reader&, Reader&)
+{
+    throw std::invalid_argument("checkpoint of this input is not supported");
+}
+void load_input(snapshot_reader& snapshot, input_parser& parser)
+{
+    parser.load(snapshot);
+}
+
+/*! parameters of synthetic workload */
+struct workload_config
+{
+    std::uint64_t jobs = 100000; /*!< number of generated processes */
+    double rate = 0.5; /*!< mean number of arrivals per tick (Poisson arrivals) */
+    unsigned int exec_min = 1; /*!< minimal execution time (scale of Pareto distribution) */
+    double exec_alpha = 1.5; /*!< shape of Pareto distribution of execution times (lower - heavier tail) */
+    unsigned int exec_max = 100000; /*!< maximal execution time */
+    std::vector<unsigned int> priorities{1, 1, 1, 1}; /*!< weights of priorities 0, 1, ... */
+    std::uint64_t seed = 1; /*!< seed of random generator */
+};
+
+/*! synthetic workload generator with the same interface as input_parser, every tick is one input line with Poisson
+ *  distributed number of arrivals, execution times are Pareto (heavy-tailed) distributed */
+class workload_generator
+{
+public:
+    explicit workload_generator(const workload_config& config)
+        : config(config), rng(config.seed), arrivals_dist(config.rate),
+          priority_dist(config.priorities.begin(), config.priorities.end())
+    {
+        if(config.rate <= 0.0 || config.exec_alpha <= 0.0 || config.exec_min == 0 || config.exec_max < config.exec_min ||
+           config.priorities.empty())
+            throw std::invalid_argument("invalid workload parameters");
+    }
+
+    /*! generates processes of the next tick, returns false if all processes were generated */
+    bool read(unsigned int& time, std::vector<proc_data>& arrivals, unsigned int& seq)
+    {
+        if(generated == config.jobs) return false;
+        time = next_time++;
+        for(auto count = arrivals_dist(rng); count != 0 && generated != config.jobs; --count, ++generated)
+        {
+            proc_data pd{};
+            pd.id = static_cast<int>(generated);
+            pd.priority = priority_dist(rng);
+            pd.exec_time = exec_time();
+            pd.seq = seq++;
+            arrivals.push_back(pd);
+        }
+        return true;
+    }
+
+private:
+    /*! returns Pareto distributed execution time */
+    unsigned int exec_time()
+    {
+        double u = 1.0 - unit_dist(rng); // (0, 1]
+        double exec = std::ceil(config.exec_min * std::pow(u, -1.0 / config.exec_alpha));
+        return exec >= config.exec_max ? config.exec_max : static_cast<unsigned int>(exec);
+    }
+
+    workload_config config; /*!< workload parameters */
+    std::mt19937_64 rng; /*!< random generator */
+    std::poisson_distribution<unsigned int> arrivals_dist; /*!< number of arrivals per tick */
+    std::discrete_distribution<int> priority_dist; /*!< priority mix */
+    std::uniform_real_distribution<double> unit_dist{0.0, 1.0}; /*!< uniform distribution of [0, 1) */
+    std::uint64_t generated = 0; /*!< number of generated processes */
+    unsigned int next_time = 0; /*!< time of the next tick */
+};
+
+/*! bounded lock-free single producer single consumer queue (pipelined mode), both sides spin while queue is full or
+ *  empty, consumer can close the queue to stop the producer */
+template<typename T>
+class spsc_queue
+{
+public:
+    /*! creates queue of at least given capacity (rounded up to a power of two) */
+    explicit spsc_queue(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while(size < capacity) size *= 2;
+        slots.resize(size);
+    }
+
+    /*! pushes value, waits while queue is full, returns false if queue was closed */
+    bool push(T value)
+    {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        while(pos - head.load(std::memory_order_acquire) == slots.size())
+        {
+            if(closed.load(std::memory_order_acquire)) return false;
+            std::this_thread::yield();
+        }
+        slots[pos & (slots.size() - 1)] = std::move(value);
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    /*! pushes value if queue is not full, returns false otherwise (value is kept) */
+    bool try_push(T& value)
+    {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        if(pos - head.load(std::memory_order_acquire) == slots.size()) return false;
+        slots[pos & (slots.size() - 1)] = std::move(value);
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    /*! pops value if queue is not empty, returns false otherwise */
+    bool try_pop(T& value)
+    {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        if(tail.load(std::memory_order_acquire) == pos) return false;
+        value = std::move(slots[pos & (slots.size() - 1)]);
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    /*! pops value, waits while queue is empty */
+    void pop(T& value)
+    {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        while(tail.load(std::memory_order_acquire) == pos)
+            std::this_thread::yield();
+        value = std::move(slots[pos & (slots.size() - 1)]);
+        head.store(pos + 1, std::memory_order_release);
+    }
+    /*! stops producer, used by consumer that does not pop anymore */
+    void close() {closed.store(true, std::memory_order_release);}
+    /*! checks if consumer closed the queue */
+    bool is_closed() const {return closed.load(std::memory_order_acquire);}
+
+private:
+    std::vector<T> slots; /*!< ring buffer of values */
+    alignas(64) std::atomic<std::size_t> head{0}; /*!< number of popped values (consumer) */
+    alignas(64) std::atomic<std::size_t> tail{0}; /*!< number of pushed values (producer) */
+    alignas(64) std::atomic<bool> closed{false}; /*!< flag for closed queue */
+};
+
+/*! whole input trace parsed once, shared read only by many simulations (batch mode) */
+class arrival_trace
+{
+public:
+    /*! parses all input lines of given parser */
+    explicit arrival_trace(input_parser& parser)
+    {
+        unsigned int time;
+        unsigned int seq = 0;
+        while(parser.read(time, procs, seq))
+            lines.push_back({time, procs.size()});
+    }
+
+    /*! one input line, its processes are procs[previous line end, end) */
+    struct line
+    {
+        unsigned int time; /*!< time of input line */
+        std::size_t end; /*!< end of line processes in procs */
+    };
+
+    std::vector<proc_data> procs; /*!< processes of all input lines */
+    std::vector<line> lines; /*!< input lines */
+};
+
+/*! reader of arrival trace with the same interface as input_parser */
+class trace_reader
+{
+public:
+    explicit trace_reader(const arrival_trace& trace) : trace(trace) {}
+
+    /*! copies processes of the next input line, returns false if there is no input remaining */
+    bool read(unsigned int& time, std::vector<proc_data>& arrivals, unsigned int& seq)
+    {
+        if(line == trace.lines.size()) return false;
+        time = trace.lines[line].time;
+        auto begin = trace.procs.begin() + static_cast<std::ptrdiff_t>(line == 0 ? 0 : trace.lines[line - 1].end);
+        auto end = trace.procs.begin() + static_cast<std::ptrdiff_t>(trace.lines[line].end);
+        arrivals.insert(arrivals.end(), begin, end);
+        seq += static_cast<unsigned int>(end - begin);
+        ++line;
+        return true;
+    }
+
+private:
+    const arrival_trace& trace; /*!< shared input trace */
+    std::size_t line = 0; /*!< next input line */
+};
+
+/*! processes of consecutive input lines passed from reader thread to simulation (pipelined mode) */
+struct arrival_block
+{
+    std::vector<proc_data> procs; /*!< processes of block lines */
+    std::vector<arrival_trace::line> lines; /*!< input lines of block, empty block ends input */
+};
+
+/*! reader of arrival blocks produced by reader thread with the same interface as input_parser (pipelined mode) */
+class pipe_reader
+{
+public:
+    explicit pipe_reader(spsc_queue<arrival_block>& queue) : queue(queue) {}
+
+    /*! copies processes of the next input line, returns false if there is no input remaining */
+    bool read(unsigned int& time, std::vector<proc_data>& arrivals, unsigned int& seq)
+    {
+        if(line == block.lines.size())
+        {
+            if(ended) return false;
+            queue.pop(block);
+            line = 0;
+            if(block.lines.empty())
+            {
+                ended = true;
+                return false;
+            }
+        }
+        time = block.lines[line].time;
+        auto begin = block.procs.begin() + static_cast<std::ptrdiff_t>(line == 0 ? 0 : block.lines[line - 1].end);
+        auto end = block.procs.begin() + static_cast<std::ptrdiff_t>(block.lines[line].end);
+        arrivals.insert(arrivals.end(), begin, end);
+        seq += static_cast<unsigned int>(end - begin);
+        ++line;
+        return true;
+    }
+
+private:
+    spsc_queue<arrival_block>& queue; /*!< blocks produced by reader thread */
+    arrival_block block; /*!< current block */
+    std::size_t line = 0; /*!< next input line of current block */
+    bool ended = false; /*!< flag for end of input */
+};
+
+/*! writes whole buffer to the file descriptor */
+void write_all(int fd, const char* data, std::size_t len)
+{
+    std::size_t written = 0;
+    while(written != len)
+    {
+        ssize_t count = ::write(fd, data + written, len - written);
+        if(count < 0 && errno == EINTR) continue;
+        if(count < 0) throw std::runtime_error("output write failed");
+        written += static_cast<std::size_t>(count);
+    }
+}
+
+/*! output writer, formats numbers into a large buffer and writes it to file descriptor in big blocks */
+class output_writer
+{
+public:
+    explicit output_writer(int fd, std::size_t block_size = 1 << 20) : fd(fd), buffer(block_size) {}
+    /*! passes full blocks to writer thread instead of writing them (pipelined mode), blocks written by writer thread are
+     *  taken back from recycled queue (if given) instead of allocating new ones */
+    explicit output_writer(spsc_queue<std::vector<char>>& pipe, spsc_queue<std::vector<char>>* recycled = nullptr,
+                           std::size_t block_size = 1 << 20)
+        : pipe(&pipe), recycled(recycled), buffer(block_size) {}
+    ~output_writer()
+    {
+        // error of writer thread is reported by pipelined mode itself
+        if(pipe == nullptr || !pipe->is_closed()) flush();
+    }
+    output_writer(const output_writer&) = delete;
+    output_writer& operator = (const output_writer&) = delete;
+
+    /*! appends number to the buffer */
+    template<typename T>
+    output_writer& operator << (T value)
+    {
+        if(buffer.size() - len < max_number_length) flush();
+        len = static_cast<std::size_t>(std::to_chars(buffer.data() + len, buffer.data() + buffer.size(), value).ptr -
+                                       buffer.data());
+        return *this;
+    }
+    /*! appends character to the buffer */
+    output_writer& operator << (char c)
+    {
+        if(len == buffer.size()) flush();
+        buffer[len++] = c;
+        return *this;
+    }
+    /*! appends text to the buffer */
+    output_writer& operator << (const char* text)
+    {
+        return write(text, std::strlen(text));
+    }
+    /*! appends number with given number of decimal places to the buffer */
+    output_writer& fixed(double value, int precision)
+    {
+        if(buffer.size() - len < max_fixed_length) flush();
+        len = static_cast<std::size_t>(std::to_chars(buffer.data() + len, buffer.data() + buffer.size(), value,
+                                                     std::chars_format::fixed, precision).ptr - buffer.data());
+        return *this;
+    }
+    /*! appends bytes to the buffer */
+    output_writer& write(const char* bytes, std::size_t count)
+    {
+        if(buffer.size() - len < count) flush();
+        if(count > buffer.size()) buffer.resize(count);
+        std::memcpy(buffer.data() + len, bytes, count);
+        len += count;
+        return *this;
+    }
+    /*! writes buffer to the file descriptor (or passes it to writer thread, throws if writer thread has failed) */
+    void flush()
+    {
+        if(pipe != nullptr && pipe->is_closed()) throw std::runtime_error("output write failed (writer thread)");
+        if(pipe != nullptr && len != 0)
+        {
+            std::vector<char> block;
+            if(recycled == nullptr || !recycled->try_pop(block)) block.reserve(buffer.size());
+            block.resize(buffer.size());
+            block.swap(buffer);
+            block.resize(len);
+            if(!pipe->push(std::move(block))) throw std::runtime_error("output write failed (writer thread)");
+        }
+        else if(pipe == nullptr) write_all(fd, buffer.data(), len);
+        written += len;
+        len = 0;
+    }
+    /*! returns number of bytes written so far (including buffered ones) */
+    std::uint64_t position() const {return written + len;}
+
+private:
+    static constexpr std::size_t max_number_length = 24; /*!< space needed for any formatted number */
+    static constexpr std::size_t max_fixed_length = 512; /*!< space needed for any number with decimal places */
+
+    int fd = -1; /*!< output file descriptor */
+    spsc_queue<std::vector<char>>* pipe = nullptr; /*!< queue of writer thread (pipelined mode) or nullptr */
+    spsc_queue<std::vector<char>>* recycled = nullptr; /*!< blocks written by writer thread or nullptr */
+    std::vector<char> buffer; /*!< output block */
+    std::size_t len = 0; /*!< length of output in buffer */
+    std::uint64_t written = 0; /*!< number of bytes written before buffer */
+};
+
+/*! binary trace encoder, writes input lines as binary trace records */
+class trace_encoder
+{
+public:
+    /*! writes binary trace header */
+    explicit trace_encoder(output_writer& out) : out(out)
+    {
+        char header[binary_header_size] = {};
+        std::memcpy(header, trace_magic, sizeof(trace_magic));
+        header[sizeof(trace_magic)] = static_cast<char>(trace_version);
+        out.write(header, sizeof(header));
+    }
+
+    /*! writes one record (input line) */
+    void write(unsigned int time, const std::vector<proc_data>& arrivals)
+    {
+        put(zigzag_encode(static_cast<std::int64_t>(time) - static_cast<std::int64_t>(record_time)));
+        put(arrivals.size());
+        for(auto & pd: arrivals)
+        {
+            put(zigzag_encode(static_cast<std::int64_t>(pd.id) - record_id));
+            put(zigzag_encode(pd.priority));
+            put((static_cast<std::uint64_t>(pd.exec_time) << 1) | (pd.burst_time != 0));
+            if(pd.burst_time != 0)
+            {
+                put(pd.burst_time);
+                put(pd.io_time);
+            }
+            record_id = pd.id;
+        }
+        record_time = time;
+    }
+
+private:
+    /*! writes varint */
+    void put(std::uint64_t value)
+    {
+        char bytes[max_varint_length];
+        out.write(bytes, encode_varint(value, bytes));
+    }
+
+    output_writer& out; /*!< output of binary trace */
+    unsigned int record_time = 0; /*!< time of previous record */
+    int record_id = 0; /*!< id of previous process */
+};
+
+/*! converts input (text or binary trace) to binary trace */
+template<typename Reader>
+void convert_to_binary(Reader& parser, output_writer& out)
+{
+    trace_encoder encoder(out);
+    std::vector<proc_data> arrivals;
+    unsigned int time = 0;
+    unsigned int seq = 0;
+    while(parser.read(time, arrivals, seq))
+    {
+        encoder.write(time, arrivals);
+        arrivals.clear();
+    }
+}
+
+/*! converts input (text or binary trace) to text input data format */
+template<typename Reader>
+void convert_to_text(Reader& parser, output_writer& out)
+{
+    std::vector<proc_data> arrivals;
+    unsigned int time = 0;
+    unsigned int seq = 0;
+    while(parser.read(time, arrivals, seq))
+    {
+        out << time;
+        for(auto & pd: arrivals)
+        {
+            out << ' ' << pd.id << ' ' << pd.priority << ' ' << pd.exec_time;
+            if(pd.burst_time != 0) out << '/' << pd.burst_time << '/' << pd.io_time;
+        }
+        out << '\n';
+        arrivals.clear();
+    }
+    out << '\n';
+}
+
+/* Output formats:
+ * ticks -> t cpu1_state cpu2_state ... (one line per tick)
+ * runs -> t n cpu1_state cpu2_state ... (one line per run of n ticks with the same CPUS states)
+ * changes -> first line: cpu_count t (first tick), then t cpu state (one line per change of CPU state, cpu is column
+ *            index counted from 0), last line: t (tick after the last printed tick), CPUS states before the first tick
+ *            are -1
+ * binary changes -> "PSCH" magic, version byte, 3 reserved bytes, then varints: cpu_count, t (first tick), for every
+ *                   change: t delta (from previous change), cpu + 1, zigzag encoded state, ends with: t delta, 0
+ * none -> CPUS states are not printed (metrics only)
+ */
+enum class output_format {ticks, runs, changes, binary_changes, none};
+
+constexpr char changes_magic[4] = {'P', 'S', 'C', 'H'}; /*!< binary changes magic */
+constexpr unsigned char changes_version = 1; /*!< binary changes format version */
+
+/*! prints scheduling result (runs of ticks with the same CPUS states) in given output format */
+class schedule_printer
+{
+public:
+    schedule_printer(output_writer& out, output_format format) : out(out), format(format) {}
+
+    /*! prints CPUS states of ticks [time, time + ticks) */
+    void print(unsigned int time, unsigned int ticks, const std::vector<int>& cpus_state)
+    {
+        PROFILE_SCOPE(output);
+        switch (format)
+        {
+            case output_format::ticks:
+            {
+                for(unsigned int end = time + ticks; time != end; ++time)
+                    print_state(time, cpus_state);
+                break;
+            }
+            case output_format::runs:
+            {
+                // runs with the same CPUS states are merged
+                if(run_ticks != 0 && run_state != cpus_state) print_run();
+                if(run_ticks == 0)
+                {
+                    run_time = time;
+                    run_state = cpus_state;
+                }
+                run_ticks += ticks;
+                break;
+            }
+            case output_format::changes:
+            case output_format::binary_changes:
+            {
+                if(run_state.empty()) print_header(time, cpus_state.size());
+                for(std::size_t cpu = 0; cpu < cpus_state.size(); ++cpu)
+                {
+                    if(run_state[cpu] == cpus_state[cpu]) continue;
+                    if(format == output_format::changes) out << time << ' ' << cpu << ' ' << cpus_state[cpu] << '\n';
+                    else
+                    {
+                        put(time - run_time);
+                        put(cpu + 1);
+                        put(zigzag_encode(cpus_state[cpu]));
+                        run_time = time;
+                    }
+                    run_state[cpu] = cpus_state[cpu];
+                }
+                run_ticks = time + ticks;
+                break;
+            }
+            case output_format::none: break;
+        }
+    }
+
+    /*! writes printed output, returns its length (checkpoint) */
+    std::uint64_t flush()
+    {
+        out.flush();
+        return out.position();
+    }
+    /*! writes not printed run (runs) or last printed states (changes) to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(run_state);
+        snapshot.put(run_time);
+        snapshot.put(run_ticks);
+    }
+    /*! reads not printed run or last printed states from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(run_state);
+        snapshot.get(run_time);
+        snapshot.get(run_ticks);
+    }
+
+    /*! prints not printed run or end of changes */
+    void finish()
+    {
+        if(format == output_format::runs && run_ticks != 0) print_run();
+        if(format == output_format::changes) out << run_ticks << '\n';
+        if(format == output_format::binary_changes)
+        {
+            put(run_ticks - run_time);
+            put(0);
+        }
+    }
+
+private:
+    /*! prints CPUS states of one tick */
+    void print_state(unsigned int time, const std::vector<int>& cpus_state)
+    {
+        out << time;
+        for(auto & cpu_state: cpus_state)
+            out << ' ' << cpu_state;
+        out << '\n';
+    }
+    /*! prints run that is not printed yet */
+    void print_run()
+    {
+        out << run_time << ' ' << run_ticks;
+        for(auto & cpu_state: run_state)
+            out << ' ' << cpu_state;
+        out << '\n';
+        run_ticks = 0;
+    }
+    /*! prints header of changes */
+    void print_header(unsigned int time, std::size_t cpu_count)
+    {
+        run_state.assign(cpu_count, -1);
+        run_time = time;
+        if(format == output_format::changes)
+        {
+            out << cpu_count << ' ' << time << '\n';
+            return;
+        }
+        char header[binary_header_size] = {};
+        std::memcpy(header, changes_magic, sizeof(changes_magic));
+        header[sizeof(changes_magic)] = static_cast<char>(changes_version);
+        out.write(header, sizeof(header));
+        put(cpu_count);
+        put(time);
+    }
+    /*! writes varint */
+    void put(std::uint64_t value)
+    {
+        char bytes[max_varint_length];
+        out.write(bytes, encode_varint(value, bytes));
+    }
+
+    output_writer& out; /*!< output of scheduling result */
+    output_format format; /*!< output format */
+    std::vector<int> run_state; /*!< CPUS states of not printed run (runs) or last printed CPUS states (changes) */
+    unsigned int run_time = 0; /*!< first tick of not printed run (runs) or tick of last change (binary changes) */
+    unsigned int run_ticks = 0; /*!< length of not printed run (runs) or tick after last printed tick (changes) */
+};
+
+/*! decodes CPUS states changes (text or binary), prints them in ticks output format */
+void decode_changes(std::FILE* file, output_writer& out)
+{
+    // read whole input
+    std::vector<char> input;
+    char block[1 << 16];
+    for(std::size_t count; (count = std::fread(block, 1, sizeof(block), file)) != 0;)
+        input.insert(input.end(), block, block + count);
+    const char* it = input.data();
+    const char* end = input.data() + input.size();
+    bool binary = input.size() >= binary_header_size && std::memcmp(it, changes_magic, sizeof(changes_magic)) == 0;
+    if(binary) it += binary_header_size;
+    // reads next number of changes
+    auto next = [&]() -> std::int64_t
+    {
+        if(binary)
+        {
+            std::uint64_t value;
+            std::size_t length = decode_varint(it, end, value);
+            if(length == 0) throw std::invalid_argument("invalid binary changes (truncated)");
+            it += length;
+            return static_cast<std::int64_t>(value);
+        }
+        while(it != end && std::isspace(static_cast<unsigned char>(*it))) ++it;
+        std::int64_t value;
+        auto result = std::from_chars(it, end, value);
+        if(result.ec != std::errc()) throw std::invalid_argument("invalid changes (not a number)");
+        it = result.ptr;
+        return value;
+    };
+    // checks if there is a number remaining in the current text line
+    auto line_continues = [&]()
+    {
+        while(it != end && (*it == ' ' || *it == '\t' || *it == '\r')) ++it;
+        return it != end && *it != '\n';
+    };
+    std::vector<int> cpus_state(static_cast<std::size_t>(next()), -1);
+    auto time = static_cast<unsigned int>(next()); // first not printed tick
+    unsigned int change_time = time;
+    while(true)
+    {
+        // read next change or end of changes
+        std::int64_t cpu = 0;
+        int state = -1;
+        if(binary)
+        {
+            change_time += static_cast<unsigned int>(next());
+            cpu = next();
+            if(cpu != 0) state = static_cast<int>(zigzag_decode(static_cast<std::uint64_t>(next())));
+        }
+        else
+        {
+            change_time = static_cast<unsigned int>(next());
+            if(line_continues())
+            {
+                cpu = next() + 1;
+                state = static_cast<int>(next());
+            }
+        }
+        for(; time < change_time; ++time)
+        {
+            out << time;
+            for(auto & cpu_state: cpus_state)
+                out << ' ' << cpu_state;
+            out << '\n';
+        }
+        if(cpu == 0) break;
+        if(cpu < 0 || static_cast<std::size_t>(cpu) > cpus_state.size())
+            throw std::invalid_argument("invalid changes (cpu out of range)");
+        cpus_state[static_cast<std::size_t>(cpu - 1)] = state;
+    }
+}
+
+/*! executes processes on CPUS for given number of ticks from time (in parallel if workers are given), pops executed
+ *  processes, processes which CPU burst has ended are blocked in timer wheel (cpus_slot keeps slots of processes that
+ *  are still executing) */
+void update_proc_list(proc_pool& proc_list, std::vector<int>& cpus_slot, unsigned int ticks, timer_wheel& blocked,
+                      unsigned int time, parallel_cpus* workers = nullptr)
+{
+    PROFILE_SCOPE(update);
+    auto execute = [&proc_list, ticks](int slot)
+    {
+        // switching process in does not execute it, only counters of process are touched
+        unsigned int& switch_time = proc_list.switch_time(slot);
+        unsigned int switch_ticks = std::min(ticks, switch_time);
+        unsigned int executed = ticks - switch_ticks;
+        switch_time -= switch_ticks;
+        proc_list.remaining_time(slot) -= executed;
+        proc_list.slice_time(slot) += executed;
+        proc_list.burst_left(slot) -= std::min(executed, proc_list.burst_left(slot)); // stays 0 without CPU bursts
+    };
+    auto it_slot = cpus_slot.begin();
+    auto retire = [&](int slot)
+    {
+        proc_data& pd = proc_list[slot];
+        if(proc_list.remaining_time(slot) == 0)
+        {
+            // pop an executed process
+            proc_list.unlink(slot);
+            proc_list.release(slot);
+        }
+        else if(pd.burst_time != 0 && proc_list.burst_left(slot) == 0)
+        {
+            // CPU burst ended, process is blocked for I/O burst (it is not in execution list until wakeup)
+            proc_list.burst_left(slot) = std::min(pd.burst_time, proc_list.remaining_time(slot));
+            pd.cpu = -1;
+            proc_list.unlink(slot);
+            blocked.push(slot, time + ticks + pd.io_time, time + ticks);
+        }
+        else *it_slot++ = slot;
+    };
+    if(workers == nullptr)
+    {
+        for(auto slot: cpus_slot)
+        {
+            execute(slot);
+            retire(slot);
+        }
+    }
+    else
+    {
+        // processes are executed in parallel, execution list is changed in order of CPUS
+        auto execute_range = [&](std::size_t begin, std::size_t end)
+        {
+            for(std::size_t i = begin; i < end; ++i)
+                execute(cpus_slot[i]);
+        };
+        workers->for_ranges(cpus_slot.size(), execute_range);
+        for(auto slot: cpus_slot)
+            retire(slot);
+    }
+    cpus_slot.erase(it_slot, cpus_slot.end());
+}
+
+/*! puts processes arrived at given time at the end of proc_list */
+void push_arrivals(proc_pool& proc_list, std::vector<proc_data>& arrivals, unsigned int time)
+{
+    for(auto & pd: arrivals)
+    {
+        pd.arrival_time = time;
+        proc_list.push_back(proc_list.acquire(pd));
+    }
+    arrivals.clear();
+}
+
+/*! look-ahead queue of input lines sorted by arrival time (same times in input order), reader fills it in batches up
+ *  to lookahead lines ahead of simulation time, simulation takes lines when time reaches their arrival time, queue is
+ *  empty until it is filled for the first time (or loaded from checkpoint) */
+template<typename Reader>
+class arrival_queue
+{
+public:
+    arrival_queue(Reader& reader, std::size_t lookahead) : reader(reader), lookahead(std::max<std::size_t>(lookahead, 1))
+    {
+        lines.reserve(this->lookahead);
+    }
+
+    /*! checks if there is no input line remaining */
+    bool empty() const {return first == lines.size();}
+    /*! returns arrival time of the next input line */
+    unsigned int next_time() const {return lines[first].time;}
+
+    /*! appends processes of all lines which arrival time has come to arrivals, returns false if there was no such line,
+     *  last_time is set to the latest arrival time of taken lines */
+    bool pop_due(unsigned int time, std::vector<proc_data>& arrivals, unsigned int& last_time)
+    {
+        bool popped = false;
+        while(!empty() && next_time() <= time)
+        {
+            for(; !empty() && next_time() <= time; ++first)
+            {
+                const line& l = lines[first];
+                for(std::size_t i = l.begin; i < l.end; ++i)
+                {
+                    arrivals.push_back(procs[i]);
+                    arrivals.back().seq = arrival_seq++; // sequence in arrival order, not in read order
+                }
+                queued -= l.end - l.begin;
+                last_time = popped ? std::max(last_time, l.time) : l.time;
+                popped = true;
+            }
+            // refill in batches when half of the window is taken, read lines may be already due
+            if(ended || lines.size() - first > lookahead / 2) break;
+            compact();
+            fill();
+        }
+        return popped;
+    }
+
+    /*! writes queued lines to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put<std::uint64_t>(lines.size() - first);
+        for(std::size_t i = first; i < lines.size(); ++i)
+        {
+            const line& l = lines[i];
+            snapshot.put(l.time);
+            snapshot.put<std::uint64_t>(l.end - l.begin);
+            snapshot.write(procs.data() + l.begin, (l.end - l.begin) * sizeof(proc_data));
+        }
+        snapshot.put(seq);
+        snapshot.put(arrival_seq);
+        snapshot.put(ended);
+    }
+    /*! reads queued lines from checkpoint (instead of the first filling) */
+    void load(snapshot_reader& snapshot)
+    {
+        lines.clear();
+        procs.clear();
+        first = queued = 0;
+        for(auto n = snapshot.get<std::uint64_t>(); n != 0; --n)
+        {
+            auto time = snapshot.get<unsigned int>();
+            std::size_t begin = procs.size();
+            snapshot.append(procs, snapshot.get<std::uint64_t>());
+            lines.push_back({time, begin, procs.size()});
+            queued += procs.size() - begin;
+        }
+        snapshot.get(seq);
+        snapshot.get(arrival_seq);
+        snapshot.get(ended);
+    }
+
+    /*! reads input lines until lookahead lines are queued or input ends */
+    void fill()
+    {
+        while(!ended && lines.size() - first < lookahead)
+        {
+            unsigned int time;
+            std::size_t begin = procs.size();
+            if(!reader.read(time, procs, seq))
+            {
+                ended = true;
+                break;
+            }
+            queued += procs.size() - begin;
+            // insert line after lines with lower or same arrival time (sorted input is appended)
+            std::size_t pos = lines.size();
+            lines.push_back({time, begin, procs.size()});
+            for(; pos > first && lines[pos - 1].time > time; --pos)
+                std::swap(lines[pos - 1], lines[pos]);
+        }
+    }
+
+private:
+    /*! input line of queue, its processes are procs[begin, end) */
+    struct line
+    {
+        unsigned int time; /*!< arrival time */
+        std::size_t begin; /*!< first process of line */
+        std::size_t end; /*!< end of line processes */
+    };
+
+    /*! drops taken lines and processes */
+    void compact()
+    {
+        lines.erase(lines.begin(), lines.begin() + static_cast<std::ptrdiff_t>(first));
+        first = 0;
+        // processes before the first queued one are taken (all of them for sorted input)
+        std::size_t begin = procs.size();
+        for(auto & l: lines)
+            begin = std::min(begin, l.begin);
+        if(procs.size() - begin <= 2 * queued + lookahead)
+        {
+            procs.erase(procs.begin(), procs.begin() + static_cast<std::ptrdiff_t>(begin));
+            for(auto & l: lines)
+            {
+                l.begin -= begin;
+                l.end -= begin;
+            }
+            return;
+        }
+        // processes of far future line keep taken processes from dropping, copy queued ones
+        scratch.clear();
+        for(auto & l: lines)
+        {
+            std::size_t scratch_begin = scratch.size();
+            scratch.insert(scratch.end(), procs.begin() + static_cast<std::ptrdiff_t>(l.begin),
+                           procs.begin() + static_cast<std::ptrdiff_t>(l.end));
+            l = {l.time, scratch_begin, scratch.size()};
+        }
+        procs.swap(scratch);
+    }
+
+    Reader& reader; /*!< input */
+    std::size_t lookahead; /*!< maximal number of queued lines */
+    std::vector<line> lines; /*!< queued lines, sorted from first */
+    std::size_t first = 0; /*!< the first not taken line */
+    std::vector<proc_data> procs; /*!< processes of queued lines */
+    std::vector<proc_data> scratch; /*!< processes buffer of compaction (temporary) */
+    std::size_t queued = 0; /*!< number of not taken processes */
+    unsigned int seq = 0; /*!< read sequence number */
+    unsigned int arrival_seq = 0; /*!< arrival sequence number */
+    bool ended = false; /*!< flag for end of input */
+};
+
+/*! FIFO of processes waiting for admission to simulation (streaming mode), processes are stored in compact records,
+ *  records over memory limit are spilled to temporary file in blocks */
+class admission_queue
+{
+public:
+    /*! creates queue keeping at most memory_limit records in memory (at least two spill blocks) */
+    explicit admission_queue(std::size_t memory_limit)
+        : block_records(std::max<std::size_t>(memory_limit / 2, 1)) {}
+    ~admission_queue()
+    {
+        if(file != nullptr) std::fclose(file);
+    }
+    admission_queue(const admission_queue&) = delete;
+    admission_queue& operator = (const admission_queue&) = delete;
+
+    /*! pushes process to the end of the queue */
+    void push(const proc_data& pd)
+    {
+        push(record{pd.arrival_time, pd.id, pd.priority, pd.exec_time, pd.seq, pd.burst_time, pd.io_time});
+    }
+    /*! pops the first process of the queue */
+    proc_data pop()
+    {
+        if(head_pos == head.size()) refill();
+        const record& r = head[head_pos++];
+        --count;
+        proc_data pd{};
+        pd.arrival_time = r.arrival_time;
+        pd.id = r.id;
+        pd.priority = r.priority;
+        pd.exec_time = r.exec_time;
+        pd.seq = r.seq;
+        pd.burst_time = r.burst_time;
+        pd.io_time = r.io_time;
+        return pd;
+    }
+    bool empty() const {return count == 0;}
+    std::size_t size() const {return count;}
+    /*! writes waiting records (in order of arrival) to checkpoint, spilled blocks are copied from temporary file */
+    void save(snapshot_writer& snapshot)
+    {
+        snapshot.put<std::uint64_t>(count);
+        snapshot.write(head.data() + head_pos, (head.size() - head_pos) * sizeof(record));
+        std::vector<record> block(spilled != 0 ? block_records : 0);
+        if(spilled != 0) std::fflush(file);
+        for(std::size_t i = 0; i < spilled; ++i)
+        {
+            std::fseek(file, static_cast<long>(read_pos + i * block_records * sizeof(record)), SEEK_SET);
+            if(std::fread(block.data(), sizeof(record), block_records, file) != block_records)
+                throw std::runtime_error("spill file read failed");
+            snapshot.write(block.data(), block_records * sizeof(record));
+        }
+        snapshot.write(tail.data(), tail.size() * sizeof(record));
+    }
+    /*! reads waiting records from checkpoint (queue is empty) */
+    void load(snapshot_reader& snapshot)
+    {
+        for(auto n = snapshot.get<std::uint64_t>(); n != 0; --n)
+            push(snapshot.get<record>());
+    }
+
+private:
+    /*! compact process record */
+    struct record
+    {
+        unsigned int arrival_time; /*!< time process arrived */
+        int id; /*!< process id */
+        int priority; /*!< process priority */
+        unsigned int exec_time; /*!< process execution time */
+        unsigned int seq; /*!< process arrival sequence number */
+        unsigned int burst_time; /*!< length of CPU bursts (0 - one CPU burst) */
+        unsigned int io_time; /*!< length of I/O bursts between CPU bursts */
+    };
+
+    /*! pushes record to the end of the queue */
+    void push(const record& r)
+    {
+        ++count;
+        // records go to the head block only if nothing is queued after it
+        if(spilled == 0 && tail.empty() && head.size() - head_pos < block_records)
+        {
+            head.push_back(r);
+            return;
+        }
+        tail.push_back(r);
+        if(tail.size() == block_records) spill();
+    }
+
+    /*! writes tail block to the end of temporary file */
+    void spill()
+    {
+        if(file == nullptr && (file = std::tmpfile()) == nullptr) throw std::runtime_error("cannot create spill file");
+        std::fseek(file, static_cast<long>(write_pos), SEEK_SET);
+        if(std::fwrite(tail.data(), sizeof(record), tail.size(), file) != tail.size())
+            throw std::runtime_error("spill file write failed");
+        write_pos += tail.size() * sizeof(record);
+        ++spilled;
+        tail.clear();
+    }
+    /*! moves the next block (from temporary file or tail) to head */
+    void refill()
+    {
+        head.clear();
+        head_pos = 0;
+        if(spilled == 0)
+        {
+            head.swap(tail);
+            return;
+        }
+        head.resize(block_records);
+        std::fflush(file);
+        std::fseek(file, static_cast<long>(read_pos), SEEK_SET);
+        if(std::fread(head.data(), sizeof(record), block_records, file) != block_records)
+            throw std::runtime_error("spill file read failed");
+        read_pos += block_records * sizeof(record);
+        // file is reused from the beginning when all spilled blocks are read
+        if(--spilled == 0) read_pos = write_pos = 0;
+    }
+
+    std::size_t block_records; /*!< records of one block */
+    std::vector<record> head; /*!< the first records (popped from head_pos) */
+    std::size_t head_pos = 0; /*!< the first not popped record of head */
+    std::vector<record> tail; /*!< the last records (not spilled yet) */
+    std::FILE* file = nullptr; /*!< temporary file of spilled blocks */
+    std::size_t spilled = 0; /*!< number of blocks in temporary file */
+    std::size_t read_pos = 0; /*!< offset of the first spilled block */
+    std::size_t write_pos = 0; /*!< offset after the last spilled block */
+    std::size_t count = 0; /*!< number of queued processes */
+};
+
+/*! returns number of ticks until the next decision point (completion, CPU burst end or time slice expiry) of executing
+ *  processes */
+unsigned int ticks_to_next_event(proc_pool& proc_list, std::vector<int>& cpus_slot)
+{
+    unsigned int ticks = std::numeric_limits<unsigned int>::max();
+    for(auto slot: cpus_slot)
+    {
+        unsigned int switch_time = proc_list.switch_time(slot);
+        ticks = std::min(ticks, switch_time + proc_list.remaining_time(slot));
+        if(proc_list[slot].burst_time != 0) // CPU burst end
+            ticks = std::min(ticks, switch_time + proc_list.burst_left(slot));
+        if(proc_list[slot].quantum != 0) // time slice expiry
+            ticks = std::min(ticks, switch_time + proc_list[slot].quantum - proc_list.slice_time(slot));
+    }
+    return ticks;
+}
+
+/*! scheduling metrics computed incrementally during simulation (turnaround, waiting and response time of processes,
+ *  CPU utilization, context switches and throughput) */
+class schedule_metrics
+{
+public:
+    /*! accounts executing processes of ticks [time, time + ticks), called before processes are executed */
+    void observe(proc_pool& proc_list, const std::vector<int>& cpus_slot, unsigned int time, unsigned int ticks)
+    {
+        for(auto slot: cpus_slot)
+        {
+            proc_data& pd = proc_list[slot];
+            if(!pd.started || pd.run_end != time) ++context_switches; // process was not executing before
+            if(!pd.started)
+            {
+                // the first dispatch of process
+                pd.started = true;
+                response.add(time - pd.arrival_time);
+                first_time = std::min(first_time, pd.arrival_time);
+            }
+            pd.run_end = time + ticks;
+            unsigned int switch_time = proc_list.switch_time(slot);
+            busy_ticks += ticks - std::min(ticks, switch_time);
+            if(switch_time + proc_list.remaining_time(slot) <= ticks)
+            {
+                // process ends in these ticks
+                unsigned int end = time + switch_time + proc_list.remaining_time(slot);
+                turnaround.add(end - pd.arrival_time);
+                waiting.add(end - pd.arrival_time - pd.exec_time - pd.io_total());
+                end_time = std::max(end_time, end);
+            }
+        }
+    }
+
+    const latency_histogram& turnaround_times() const {return turnaround;} /*!< arrival to completion */
+    const latency_histogram& waiting_times() const {return waiting;} /*!< turnaround without CPU and I/O bursts */
+    const latency_histogram& response_times() const {return response;} /*!< arrival to the first dispatch */
+    std::uint64_t cpu_busy_ticks() const {return busy_ticks;} /*!< sum of ticks CPUS executed processes */
+    std::uint64_t dispatches() const {return context_switches;} /*!< number of dispatches of processes to CPUS */
+
+    /*! returns time from the first arrival to the last completion */
+    unsigned int makespan() const {return turnaround.count() == 0 ? 0 : end_time - first_time;}
+    /*! returns fraction of CPUS ticks of makespan spent executing processes */
+    double cpu_utilization(std::size_t cpu_count) const
+    {
+        return makespan() == 0 ? 0.0 : static_cast<double>(busy_ticks) / (static_cast<double>(makespan()) *
+                                                                         static_cast<double>(cpu_count));
+    }
+    /*! returns number of completed processes per tick */
+    double throughput() const
+    {
+        return makespan() == 0 ? 0.0 : static_cast<double>(turnaround.count()) / makespan();
+    }
+
+    /*! prints summary of metrics */
+    void print(output_writer& out, std::size_t cpu_count) const
+    {
+        out << "jobs " << turnaround.count() << '\n';
+        out << "makespan " << makespan() << '\n';
+        out << "cpu_utilization ";
+        out.fixed(cpu_utilization(cpu_count), 4) << '\n';
+        out << "throughput ";
+        out.fixed(throughput(), 4) << '\n';
+        out << "context_switches " << context_switches << '\n';
+        print_histogram(out, "turnaround ", turnaround);
+        print_histogram(out, "waiting ", waiting);
+        print_histogram(out, "response ", response);
+    }
+
+    /*! columns of metrics row */
+    static constexpr const char* row_header = "jobs makespan cpu_utilization throughput context_switches turnaround_mean "
+                                              "turnaround_p99 waiting_mean waiting_p99 response_mean response_p99";
+    /*! prints metrics as one row of space separated values (without end of line) */
+    void print_row(output_writer& out, std::size_t cpu_count) const
+    {
+        out << turnaround.count() << ' ' << makespan() << ' ';
+        out.fixed(cpu_utilization(cpu_count), 4) << ' ';
+        out.fixed(throughput(), 4) << ' ' << context_switches;
+        for(auto histogram: {&turnaround, &waiting, &response})
+        {
+            out << ' ';
+            out.fixed(histogram->mean(), 4) << ' ' << histogram->percentile(99);
+        }
+    }
+
+    /*! writes metrics to checkpoint */
+    void save(snapshot_writer& snapshot) const
+    {
+        turnaround.save(snapshot);
+        waiting.save(snapshot);
+        response.save(snapshot);
+        snapshot.put(busy_ticks);
+        snapshot.put(context_switches);
+        snapshot.put(first_time);
+        snapshot.put(end_time);
+    }
+    /*! reads metrics from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        turnaround.load(snapshot);
+        waiting.load(snapshot);
+        response.load(snapshot);
+        snapshot.get(busy_ticks);
+        snapshot.get(context_switches);
+        snapshot.get(first_time);
+        snapshot.get(end_time);
+    }
+
+private:
+    /*! prints mean, percentiles and maximum of histogram */
+    static void print_histogram(output_writer& out, const char* label, const latency_histogram& histogram)
+    {
+        out << label << "mean ";
+        out.fixed(histogram.mean(), 4) << " p50 " << histogram.percentile(50) << " p90 " << histogram.percentile(90);
+        out << " p99 " << histogram.percentile(99) << " max " << histogram.maximum() << '\n';
+    }
+
+    latency_histogram turnaround; /*!< turnaround times (arrival to completion) */
+    latency_histogram waiting; /*!< waiting times (turnaround time without execution time and I/O bursts) */
+    latency_histogram response; /*!< response times (arrival to the first dispatch) */
+    std::uint64_t busy_ticks = 0; /*!< sum of ticks CPUS executed processes */
+    std::uint64_t context_switches = 0; /*!< number of dispatches of processes to CPUS */
+    unsigned int first_time = std::numeric_limits<unsigned int>::max(); /*!< the first arrival time */
+    unsigned int end_time = 0; /*!< the last completion time */
+};
+
+/*! configuration of one simulation */
+struct schedule_config
+{
+    unsigned int method = 0; /*!< scheduling method */
+    unsigned int cpu_count = 1; /*!< number of CPUS */
+    unsigned int rr_time = 1; /*!< Round Robin slice time */
+    bool event_driven = false; /*!< event-driven engine */
+    output_format format = output_format::ticks; /*!< output format */
+    cpu_affinity affinity; /*!< CPU affinity model */
+    unsigned int local_method = 0; /*!< schedule method of multi-queue per CPU queues, FCFS or SRTF */
+    unsigned int steal_threshold = 1; /*!< minimal number of waiting processes to steal from (multi-queue) */
+    unsigned int mlfq_levels = 3; /*!< number of MLFQ levels, used if mlfq_quanta are not given */
+    std::vector<unsigned int> mlfq_quanta; /*!< time quantum of every MLFQ level */
+    unsigned int mlfq_boost = 0; /*!< period of MLFQ priority boost, 0 - off */
+    unsigned int min_granularity = 1; /*!< minimal execution time before preemption (fair) */
+    bool metrics = false; /*!< flag for printing summary of scheduling metrics */
+    std::size_t capacity = 0; /*!< expected maximal number of processes in simulation (preallocation hint) */
+    std::size_t backlog_limit = 0; /*!< maximal number of processes in simulation, others wait for admission (0 - off) */
+    std::size_t spill_limit = 1 << 20; /*!< maximal number of processes waiting for admission kept in memory */
+    std::size_t lookahead = 1024; /*!< number of input lines read ahead of simulation time (sorted by arrival time) */
+    unsigned int cpu_threads = 1; /*!< number of threads executing independent CPUS of multi-queue method */
+    std::string checkpoint_path; /*!< checkpoint file (empty - no checkpoints) */
+    unsigned int checkpoint_interval = 0; /*!< simulated ticks between checkpoints */
+
+    /*! checks configuration, fills default values which depend on other values */
+    void check()
+    {
+        if(method > 9) throw std::invalid_argument("invalid schedule method");
+        if(local_method != 0 && local_method != 2) throw std::invalid_argument("invalid multi-queue local schedule method");
+        if(rr_time == 0) throw std::invalid_argument("invalid round robin slice time");
+        // MLFQ quanta default to RR slice time doubled on every level (saturated at maximal value)
+        if(mlfq_quanta.empty())
+        {
+            constexpr unsigned int max_quantum = std::numeric_limits<unsigned int>::max();
+            for(unsigned int level = 0; level < mlfq_levels && level < mlfq_state::max_levels; ++level)
+                mlfq_quanta.push_back(level < std::numeric_limits<unsigned int>::digits && rr_time <= (max_quantum >> level)
+                                      ? rr_time << level : max_quantum);
+            if(mlfq_quanta.empty()) mlfq_quanta.push_back(rr_time);
+        }
+        if((affinity.switch_cost != 0 || affinity.migration_cost != 0) && method != 7) affinity.enabled = true;
+        if(checkpoint_path.empty() != (checkpoint_interval == 0))
+            throw std::invalid_argument("checkpoint needs both file and interval");
+    }
+
+    /*! writes parameters of simulation to checkpoint (hints and checkpoint settings are not written) */
+    void save(snapshot_writer& snapshot) const
+    {
+        snapshot.put(method);
+        snapshot.put(cpu_count);
+        snapshot.put(rr_time);
+        snapshot.put(event_driven);
+        snapshot.put(format);
+        snapshot.put(affinity.enabled);
+        snapshot.put(affinity.switch_cost);
+        snapshot.put(affinity.migration_cost);
+        snapshot.put(local_method);
+        snapshot.put(steal_threshold);
+        snapshot.put(mlfq_quanta);
+        snapshot.put(mlfq_boost);
+        snapshot.put(min_granularity);
+        snapshot.put(metrics);
+        snapshot.put(backlog_limit);
+        snapshot.put(spill_limit);
+        snapshot.put(lookahead);
+    }
+    /*! reads parameters of simulation from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        snapshot.get(method);
+        snapshot.get(cpu_count);
+        snapshot.get(rr_time);
+        snapshot.get(event_driven);
+        snapshot.get(format);
+        snapshot.get(affinity.enabled);
+        snapshot.get(affinity.switch_cost);
+        snapshot.get(affinity.migration_cost);
+        snapshot.get(local_method);
+        snapshot.get(steal_threshold);
+        snapshot.get(mlfq_quanta);
+        snapshot.get(mlfq_boost);
+        snapshot.get(min_granularity);
+        snapshot.get(metrics);
+        snapshot.get(backlog_limit);
+        snapshot.get(spill_limit);
+        snapshot.get(lookahead);
+    }
+};
+
+/* Schedule policies:
+ * Every policy type has state_type (waiting processes of the policy, constructed from pool of processes and
+ * configuration, written to and read from checkpoints by save() and load()), static function schedule() executed at decision points and static function ticks_to_event() returning
+ * ticks until the next decision point of the policy itself. Simulation engines are instantiated for every policy type,
+ * the schedule method is dispatched only once at startup (see with_policy()).
+ */
+
+/*! defaults of schedule policy */
+struct policy_base
+{
+    static constexpr bool per_cpu_states = false; /*!< policy places processes on CPUS itself (no affinity placing) */
+
+    /*! returns number of ticks until the next decision point of policy (none) */
+    template<typename State>
+    static unsigned int ticks_to_event(const State&, unsigned int) {return std::numeric_limits<unsigned int>::max();}
+    /*! returns worker threads executing processes of CPUS in parallel (none) */
+    template<typename State>
+    static parallel_cpus* workers(State&) {return nullptr;}
+};
+
+/*! First Come First Serve policy */
+struct fcfs_policy : policy_base
+{
+    struct state_type
+    {
+        state_type(const proc_pool&, const schedule_config&) {}
+
+        void save(snapshot_writer&) const {}
+        void load(snapshot_reader&) {}
+    };
+
+    static void schedule(proc_pool& proc_list, state_type&, std::vector<int>& cpus_slot, std::vector<int>& cpus_state,
+                         const schedule_config&, unsigned int)
+    {
+        fcfs(proc_list, cpus_slot, cpus_state);
+    }
+};
+
+/*! ready queue policy, waiting processes are ordered by Key (same keys by arrival), preemptive policy queues executing
+ *  processes together with waiting processes, non preemptive policy queues only processes after executing processes */
+template<typename Key, bool Preemptive>
+struct queue_policy : policy_base
+{
+    struct state_type
+    {
+        state_type(const proc_pool& pool, const schedule_config& config) : queue(pool) {queue.reserve(config.capacity);}
+
+        void save(snapshot_writer& snapshot) const {queue.save(snapshot);}
+        void load(snapshot_reader& snapshot) {queue.load(snapshot);}
+
+        basic_ready_queue<Key> queue; /*!< processes waiting for CPU */
+    };
 
-    /*! static function for comparing proc_data structures in term of execution time (same values not swapped) */
-    static bool compare_exec_time(proc_data pd1, proc_data pd2) {return (pd1.exec_time < pd2.exec_time);}
-    /*! static function for comparing proc_data structures in term of priority (same values not swapped) */
-    static bool compare_priority(proc_data pd1, proc_data pd2) {return (pd1.priority < pd2.priority);}
-    /*! static function for comparing proc_data structures in term of remaining execution time (same values not swapped) */
-    static bool compare_remaining_time(proc_data pd1, proc_data pd2) {return (pd1.remaining_time < pd2.remaining_time);}
+    static void schedule(proc_pool& proc_list, state_type& state, std::vector<int>& cpus_slot,
+                         std::vector<int>& cpus_state, const schedule_config&, unsigned int)
+    {
+        int first = Preemptive ? proc_list.front() : first_waiting(proc_list, cpus_slot);
+        dispatch(proc_list, first, state.queue, cpus_state.size());
+        update_cpus_state(proc_list, cpus_slot, cpus_state);
+    }
 };
-/*! input operator >> overload for proc_data structure */
-std::istream& operator >> (std::istream& is, proc_data& pd)
+
+/*! Shortest Job First policy, queues only processes after executing processes in terms of execution time */
+using sjf_policy = queue_policy<key_of<proc_pool::key_exec_time>, false>;
+/*! Shortest Remaining Time First policy, queues all processes in terms of remaining execution time */
+using srtf_policy = queue_policy<key_of<proc_pool::key_remaining_time>, true>;
+/*! Priority with preemption policy, queues all processes in terms of priority, same priorities in terms of arrival */
+using prio_fcfs_policy = queue_policy<key_of<proc_pool::key_priority>, true>;
+/*! Priority with preemption policy, queues all processes in terms of priority, same priorities in terms of remaining
+ *  execution time (one fused key) */
+using prio_srtf_policy = queue_policy<key_of<proc_pool::key_priority_remaining_time>, true>;
+/*! Priority without preemption policy, queues only processes after executing processes in terms of priority (same
+ *  priorities in terms of arrival) */
+using prio_fcfs_no_preemption_policy = queue_policy<key_of<proc_pool::key_priority>, false>;
+
+/*! Round Robin policy */
+struct rr_policy : policy_base
 {
-    is >> pd.id >> pd.priority >> pd.exec_time ;
-    pd.remaining_time = pd.exec_time;
-    return is;
-}
+    struct state_type
+    {
+        state_type(const proc_pool&, const schedule_config& config) {queue.reserve(config.capacity);}
+
+        void save(snapshot_writer& snapshot) const {queue.save(snapshot);}
+        void load(snapshot_reader& snapshot) {queue.load(snapshot);}
+
+        rr_queue queue; /*!< processes waiting for CPU */
+        std::vector<int> expired; /*!< executing processes which time slice has ended (temporary) */
+    };
 
+    static void schedule(proc_pool& proc_list, state_type& state, std::vector<int>& cpus_slot,
+                         std::vector<int>& cpus_state, const schedule_config& config, unsigned int)
+    {
+        rr(proc_list, state.queue, cpus_slot, cpus_state, config.rr_time, state.expired);
+    }
+};
 
-/*! puts scheduled processes on CPU/CPUS */
-void update_cpus_state(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! Multi-queue with work stealing policy, local queues are scheduled and processes executed in parallel by
+ *  config.cpu_threads threads */
+struct multi_queue_policy : policy_base
 {
-    auto it_proc = proc_list.begin();
-    for(auto & cpu_state:cpus_state)
+    static constexpr bool per_cpu_states = true;
+
+    struct state_type
     {
-        if(it_proc == proc_list.end())
+        state_type(const proc_pool& pool, const schedule_config& config)
+            : mq(pool, config.cpu_count, config.local_method)
         {
-            cpu_state = -1;
+            mq.steal_threshold = config.steal_threshold;
+            mq.migration_cost = config.affinity.migration_cost;
+            if(config.cpu_threads > 1) mq.workers = std::make_unique<parallel_cpus>(config.cpu_threads);
         }
-        else
+
+        void save(snapshot_writer& snapshot) const {mq.save(snapshot);}
+        void load(snapshot_reader& snapshot) {mq.load(snapshot);}
+
+        multi_queue_state mq; /*!< per CPU queues */
+    };
+
+    static void schedule(proc_pool& proc_list, state_type& state, std::vector<int>& cpus_slot,
+                         std::vector<int>& cpus_state, const schedule_config&, unsigned int)
+    {
+        multi_queue(proc_list, state.mq, cpus_slot, cpus_state);
+    }
+    static parallel_cpus* workers(state_type& state) {return state.mq.workers.get();}
+};
+
+/*! Multi-level feedback queue policy, priority boost is a decision point */
+struct mlfq_policy : policy_base
+{
+    struct state_type
+    {
+        state_type(const proc_pool&, const schedule_config& config) : levels(config.mlfq_quanta, config.mlfq_boost) {}
+
+        void save(snapshot_writer& snapshot) const {levels.save(snapshot);}
+        void load(snapshot_reader& snapshot) {levels.load(snapshot);}
+
+        mlfq_state levels; /*!< levels of processes */
+        std::vector<int> rotated; /*!< executing processes which quantum started again (temporary) */
+    };
+
+    static void schedule(proc_pool& proc_list, state_type& state, std::vector<int>& cpus_slot,
+                         std::vector<int>& cpus_state, const schedule_config&, unsigned int time)
+    {
+        mlfq(proc_list, state.levels, cpus_slot, cpus_state, time, state.rotated);
+    }
+    static unsigned int ticks_to_event(const state_type& state, unsigned int time)
+    {
+        return state.levels.ticks_to_boost(time);
+    }
+};
+
+/*! Fair policy */
+struct fair_policy : policy_base
+{
+    struct state_type
+    {
+        state_type(const proc_pool&, const schedule_config& config) : fs(config.min_granularity)
         {
-            cpu_state = it_proc->id;
-            ++it_proc;
+            fs.reserve(config.capacity);
         }
+
+        void save(snapshot_writer& snapshot) const {fs.save(snapshot);}
+        void load(snapshot_reader& snapshot) {fs.load(snapshot);}
+
+        fair_state fs; /*!< waiting processes ordered by virtual runtime */
+    };
+
+    static void schedule(proc_pool& proc_list, state_type& state, std::vector<int>& cpus_slot,
+                         std::vector<int>& cpus_state, const schedule_config&, unsigned int)
+    {
+        fair(proc_list, state.fs, cpus_slot, cpus_state);
     }
-    /* sort processes on CPUS from lower to higher, negative numbers pushed at the end (-1 -> CPU sleep) */
-    std::stable_sort(cpus_state.begin(), cpus_state.end(), [](int i, int j){return (i >= 0 && j >= 0) ? i < j : i > j;});
-}
+};
 
-/*! First Come First Serve scheduling algorithm */
-void fcfs(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! calls function with policy object of given schedule method (the only dispatch on schedule method) */
+template<typename Function>
+void with_policy(unsigned int method, Function&& function)
 {
-    /* processes are already sorted */
-    update_cpus_state(proc_list, cpus_state);
+    switch (method)
+    {
+        case 0: function(fcfs_policy()); break; // FCFS
+        case 1: function(sjf_policy()); break; // SJF
+        case 2: function(srtf_policy()); break; // SRTF
+        case 3: function(rr_policy()); break; // RR
+        case 4: function(prio_fcfs_policy()); break; // Priority_FCFS
+        case 5: function(prio_srtf_policy()); break; // Priority_SRTF
+        case 6: function(prio_fcfs_no_preemption_policy()); break; // Priority without preemption (FCFS)
+        case 7: function(multi_queue_policy()); break; // multi-queue
+        case 8: function(mlfq_policy()); break; // MLFQ
+        case 9: function(fair_policy()); break; // fair
+        default: throw std::invalid_argument("invalid schedule method"); // Wrong method, raises error
+    }
 }
 
-/*! Shortest Job First scheduling algorithm */
-void sjf(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! state of one simulation of given policy */
+template<typename Policy>
+struct schedule_state
+{
+    explicit schedule_state(const schedule_config& config)
+        : policy(proc_list, config), cpus_state(config.cpu_count, -1), affinity(config.affinity),
+          admission(config.spill_limit)
+    {
+        proc_list.reserve(config.capacity);
+        cpus_slot.reserve(config.cpu_count);
+    }
+
+    /*! writes state to checkpoint (between ticks, no arrived processes) */
+    void save(snapshot_writer& snapshot)
+    {
+        proc_list.save(snapshot);
+        policy.save(snapshot);
+        snapshot.put(cpus_slot);
+        snapshot.put(cpus_state);
+        snapshot.put(affinity.round);
+        snapshot.put(affinity.cpus_proc);
+        snapshot.put(affinity.cpus_last);
+        admission.save(snapshot);
+        blocked.save(snapshot);
+    }
+    /*! reads state from checkpoint */
+    void load(snapshot_reader& snapshot)
+    {
+        std::size_t cpu_count = cpus_state.size();
+        proc_list.load(snapshot);
+        policy.load(snapshot);
+        snapshot.get(cpus_slot);
+        snapshot.get(cpus_state);
+        if(cpus_state.size() != cpu_count) throw std::invalid_argument("invalid checkpoint (number of CPUS)");
+        snapshot.get(affinity.round);
+        snapshot.get(affinity.cpus_proc);
+        snapshot.get(affinity.cpus_last);
+        admission.load(snapshot);
+        blocked.load(snapshot);
+    }
+
+    proc_pool proc_list; /*!< processes execution list */
+    typename Policy::state_type policy; /*!< processes waiting for CPU (policy state) */
+    std::vector<int> cpus_slot; /*!< proc_list slots of executing processes */
+    std::vector<proc_data> arrivals; /*!< processes of the input line */
+    std::vector<int> cpus_state; /*!< CPU states list, CPUS start in sleep state (original program started them as 0) */
+    cpu_affinity affinity; /*!< CPU affinity model */
+    admission_queue admission; /*!< processes waiting for admission (backlog limit) */
+    timer_wheel blocked; /*!< processes blocked for I/O */
+};
+
+/*! puts processes arrived at given time to simulation, processes over backlog limit wait for admission */
+template<typename Policy>
+void push_arrivals(const schedule_config& config, schedule_state<Policy>& state, unsigned int time)
 {
-    /* prevent preemption by moving iterator after executing processes */
-    auto proc_it = proc_list.begin();
-    for(auto cpu_state: cpus_state)
+    if(config.backlog_limit == 0)
     {
-        if(proc_it == proc_list.end() || cpu_state == -1) break;
-        for(auto proc: proc_list)
-            if(cpu_state == proc.id) proc_it++;
+        push_arrivals(state.proc_list, state.arrivals, time);
+        return;
     }
-    /* sort remaining processes in terms of execution time */
-    std::stable_sort (proc_it, proc_list.end(), proc_data::compare_exec_time);
-    update_cpus_state(proc_list, cpus_state);
+    for(auto & pd: state.arrivals)
+    {
+        pd.arrival_time = time;
+        state.admission.push(pd);
+    }
+    state.arrivals.clear();
 }
 
-/*! Shortest Remaining Time First scheduling algorithm */
-void srtf(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! admits waiting processes (in order of arrival) while number of processes in simulation is under backlog limit */
+template<typename Policy>
+void admit(const schedule_config& config, schedule_state<Policy>& state)
 {
-    /* sort processes in terms of execution time */
-    std::stable_sort (proc_list.begin(), proc_list.end(), proc_data::compare_remaining_time);
-    update_cpus_state(proc_list, cpus_state);
+    while(!state.admission.empty() && state.proc_list.live() < config.backlog_limit)
+        state.proc_list.push_back(state.proc_list.acquire(state.admission.pop()));
 }
 
-/*! Round Robin scheduling algorithm */
-void rr(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state, unsigned int rr_time)
+/*! runs policy on state at given time (processes which I/O burst has ended are woken up first), places processes on
+ *  CPUS in affinity mode */
+template<typename Policy>
+void schedule(const schedule_config& config, schedule_state<Policy>& state, unsigned int time)
 {
-    for(auto cpu_state: cpus_state)
+    if(!state.blocked.empty()) state.blocked.pop_due(state.proc_list, time);
+    if(!state.admission.empty()) admit(config, state);
     {
-        if(cpu_state == -1) break;
-        auto proc_it = proc_list.begin();
-        /* move iterator to executing process */
-        while(cpu_state != proc_it->id && proc_it != proc_list.end()) proc_it++;
-        if (proc_it == proc_list.end()) continue;
-        /* check if executing process needs to be pushed to the end of process list (if RR time slice has ended) */
-        unsigned int proc_executed_time = proc_it->exec_time - proc_it->remaining_time;
-        if( proc_executed_time > 0 && proc_executed_time % rr_time == 0)
-        {
-            /* push process to the end of process list  */
-            proc_data pd = *proc_it;
-            proc_list.erase(proc_it);
-            proc_list.push_back(pd);
-        }
+        PROFILE_SCOPE(schedule);
+        Policy::schedule(state.proc_list, state.policy, state.cpus_slot, state.cpus_state, config, time);
+    }
+    PROFILE_QUEUE_DEPTH(state.proc_list.live() - state.cpus_slot.size());
+    if(state.affinity.enabled && !Policy::per_cpu_states)
+    {
+        PROFILE_SCOPE(place);
+        place_on_cpus(state.proc_list, state.cpus_slot, state.cpus_state, state.affinity);
     }
-    update_cpus_state(proc_list, cpus_state);
 }
 
-/*! Priority with preemption scheduling algorithm, same priorities are scheduled using FCFS algorithm */
-void prio_fcfs(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! returns number of ticks until the next decision point of executing processes, policy or blocked processes */
+template<typename Policy>
+unsigned int ticks_to_decision(schedule_state<Policy>& state, unsigned int time)
 {
-    /* sort processes in terms of priority, same priorities are already sorted */
-    std::stable_sort (proc_list.begin(), proc_list.end(), proc_data::compare_priority);
-    update_cpus_state(proc_list, cpus_state);
+    unsigned int ticks = std::min(ticks_to_next_event(state.proc_list, state.cpus_slot),
+                                  Policy::ticks_to_event(state.policy, time));
+    return state.blocked.empty() ? ticks : std::min(ticks, state.blocked.ticks_to_wakeup(time));
 }
 
-/*! Priority with preemption scheduling algorithm, same priorities are scheduled using SRTF algorithm */
-void prio_srtf(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/*! executes scheduled processes for given number of ticks from time, metrics are observed if given */
+template<typename Policy>
+void execute(schedule_state<Policy>& state, schedule_metrics* metrics, unsigned int time, unsigned int ticks)
 {
-    /* sort processes in terms of remaining execution time (same priority) */
-    std::stable_sort (proc_list.begin(), proc_list.end(), proc_data::compare_remaining_time);
-    /* sort processes in terms of priority */
-    std::stable_sort (proc_list.begin(), proc_list.end(), proc_data::compare_priority);
-    update_cpus_state(proc_list, cpus_state);
+    if(metrics != nullptr) metrics->observe(state.proc_list, state.cpus_slot, time, ticks);
+    update_proc_list(state.proc_list, state.cpus_slot, ticks, state.blocked, time, Policy::workers(state.policy));
 }
 
-/*! Priority without preemption scheduling algorithm, same priorities are scheduled using FCFS algorithm */
-void prio_fcfs_no_preemption(std::vector<proc_data>& proc_list, std::vector<int>& cpus_state)
+/* Checkpoint format:
+ * header -> "PSCP" magic, version byte, 3 reserved bytes, length of output written before checkpoint
+ * then parameters of simulation, time, end time, simulation state (processes, policy state, CPUS, admission queue,
+ * blocked processes), arrival queue, input position, printer state and metrics, ends with magic
+ * Values are stored in native byte order, vectors are prefixed by their 64 bit size. Checkpoint is taken between ticks,
+ * so resumed simulation continues exactly where the checkpointed one was.
+ */
+constexpr char checkpoint_magic[4] = {'P', 'S', 'C', 'P'}; /*!< checkpoint magic */
+constexpr unsigned char checkpoint_version = 4; /*!< checkpoint format version */
+
+/*! writes checkpoint of simulation at given time, checkpoint is written to temporary file renamed over the previous
+ *  checkpoint when it is complete (previous checkpoint stays valid if program is interrupted) */
+template<typename Policy, typename Reader>
+void write_checkpoint(const schedule_config& config, schedule_state<Policy>& state, const arrival_queue<Reader>& arrivals,
+                      const Reader& reader, schedule_printer& printer, const schedule_metrics* metrics,
+                      unsigned int time, unsigned int end_time)
 {
-    /* prevent preemption by moving iterator after executing processes */
-    auto proc_it = proc_list.begin();
-    for(auto cpu_state: cpus_state)
-    {
-        if(proc_it == proc_list.end() || cpu_state == -1) break;
-        for(auto proc: proc_list)
-            if(cpu_state == proc.id) proc_it++;
-    }
-    /* sort processes in terms of priority, same priorities are already sorted */
-    std::stable_sort (proc_it, proc_list.end(), proc_data::compare_priority);
-    update_cpus_state(proc_list, cpus_state);
+    std::string temporary = config.checkpoint_path + ".tmp";
+    snapshot_writer snapshot(temporary);
+    char header[binary_header_size] = {};
+    std::memcpy(header, checkpoint_magic, sizeof(checkpoint_magic));
+    header[sizeof(checkpoint_magic)] = static_cast<char>(checkpoint_version);
+    snapshot.write(header, sizeof(header));
+    snapshot.put<std::uint64_t>(printer.flush()); // output written before checkpoint
+    config.save(snapshot);
+    snapshot.put(time);
+    snapshot.put(end_time);
+    state.save(snapshot);
+    arrivals.save(snapshot);
+    save_input(snapshot, reader);
+    printer.save(snapshot);
+    if(metrics != nullptr) metrics->save(snapshot);
+    snapshot.write(checkpoint_magic, sizeof(checkpoint_magic));
+    snapshot.close();
+    if(std::rename(temporary.c_str(), config.checkpoint_path.c_str()) != 0)
+        throw std::runtime_error("cannot rename checkpoint file " + temporary);
 }
 
-/*! checks if all CPUS are sleeping (==-1) */
-bool all_cpus_sleeping(std::vector<int>& cpus_state)
+/*! reads checkpoint header and parameters of simulation (rest of checkpoint is read by resumed simulation), returns
+ *  length of output written before checkpoint */
+std::uint64_t read_checkpoint_header(snapshot_reader& snapshot, schedule_config& config)
 {
-    if(std::any_of(cpus_state.begin(), cpus_state.end(), [](int i){return i != -1;}))
-        return false;
-    return true;
+    char header[binary_header_size];
+    snapshot.read(header, sizeof(header));
+    if(std::memcmp(header, checkpoint_magic, sizeof(checkpoint_magic)) != 0)
+        throw std::invalid_argument("invalid checkpoint file");
+    if(static_cast<unsigned char>(header[sizeof(checkpoint_magic)]) != checkpoint_version)
+        throw std::invalid_argument("unsupported checkpoint version");
+    auto output_length = snapshot.get<std::uint64_t>();
+    config.load(snapshot);
+    return output_length;
 }
 
-int main(int argc, char* argv[])
+/*! truncates regular output file to length of output written before checkpoint, so output of resumed simulation
+ *  continues it (output shorter than that, e.g. new file, is kept) */
+void truncate_output(int fd, std::uint64_t length)
 {
-    unsigned int method; // scheduling method (arg1)
-    unsigned int cpu_count = 1; // number of CPUS (arg2), default 1
-    unsigned int rr_time = 1; // Round Robin slice time (arg3), default 1
-    // read first argument (schedule method)
-    if(argc < 2) throw std::invalid_argument("arg1 not given (schedule method)");
-    else method = static_cast<unsigned int>(std::strtol(argv[1], nullptr, 0));
-    // check for second argument (CPU count)
-    if(argc >= 3) cpu_count = static_cast<unsigned int>(std::strtol(argv[2], nullptr, 0));
-    // check for third argument (round robin time step)
-    if(argc >= 4) rr_time = static_cast<unsigned int>(std::strtol(argv[3], nullptr, 0));
+    struct stat st{};
+    if(::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<std::uint64_t>(st.st_size) < length) return;
+    if(::ftruncate(fd, static_cast<off_t>(length)) != 0 || ::lseek(fd, 0, SEEK_END) < 0)
+        throw std::runtime_error("cannot truncate output file");
+}
+
+/*! simulation of given policy, processes are taken from look-ahead arrival queue when time reaches their arrival time
+ *  (gaps between arrival times are simulated), tick engine executes schedule method and prints CPUS states every tick,
+ *  event-driven engine executes schedule method only at decision points (arrival, completion, time slice expiry or
+ *  policy event) and prints CPUS states as runs, checkpoint is written every checkpoint interval (at the first tick
+ *  after it), simulation continues from resume checkpoint if given, returns the tick after the last printed tick */
+template<typename Policy, typename Reader>
+unsigned int run_engine(Reader& reader, schedule_printer& printer, const schedule_config& config,
+                        schedule_metrics* metrics, snapshot_reader* resume = nullptr)
+{
+    schedule_state<Policy> state(config); // simulation state
+    arrival_queue<Reader> arrivals(reader, config.lookahead); // input lines ahead of simulation time
+    unsigned int time; // simulation time
+    unsigned int end_time; // tick after the last input line
+    if(resume != nullptr)
+    {
+        resume->get(time);
+        resume->get(end_time);
+        state.load(*resume);
+        arrivals.load(*resume);
+        load_input(*resume, reader);
+        printer.load(*resume);
+        if(metrics != nullptr) metrics->load(*resume);
+        char end[sizeof(checkpoint_magic)];
+        resume->read(end, sizeof(end));
+        if(std::memcmp(end, checkpoint_magic, sizeof(checkpoint_magic)) != 0)
+            throw std::invalid_argument("invalid checkpoint file");
+    }
+    else
+    {
+        arrivals.fill();
+        time = end_time = arrivals.empty() ? 0 : arrivals.next_time();
+    }
+    // time of the next checkpoint (64 bits, so no simulation time reaches it without checkpoints)
+    auto checkpoint_after = [&](unsigned int now)
+    {
+        return config.checkpoint_interval == 0 ? std::numeric_limits<std::uint64_t>::max()
+                                               : std::uint64_t(now) + config.checkpoint_interval;
+    };
+    std::uint64_t next_checkpoint = checkpoint_after(time);
+    while(true)
+    {
+        // push processes which arrival time has come
+        unsigned int last_time;
+        if(arrivals.pop_due(time, state.arrivals, last_time))
+        {
+            push_arrivals(config, state, time);
+            end_time = std::max(end_time, last_time + 1);
+        }
+        schedule(config, state, time);
+        // find next decision point
+        unsigned int ticks = 1;
+        if(config.event_driven)
+        {
+            ticks = ticks_to_decision(state, time);
+            if(!arrivals.empty()) ticks = std::min(ticks, arrivals.next_time() - time);
+            else if(time < end_time) ticks = std::min(ticks, end_time - time);
+            else if(all_cpus_sleeping(state.cpus_state) && state.blocked.empty()) ticks = 1; // last printed tick
+        }
+        // print output
+        printer.print(time, ticks, state.cpus_state);
+        // run until there is no input, all CPUS are sleeping and no process waits for admission or I/O
+        if(arrivals.empty() && time >= end_time && all_cpus_sleeping(state.cpus_state) && state.admission.empty() &&
+           state.blocked.empty())
+            return time + ticks;
+        execute(state, metrics, time, ticks);
+        time += ticks;
+        if(!config.checkpoint_path.empty() && time >= next_checkpoint)
+        {
+            write_checkpoint(config, state, arrivals, reader, printer, metrics, time, end_time);
+            next_checkpoint = checkpoint_after(time);
+        }
+    }
+}
+
+/*! simulation driven in-process by caller (library API), jobs arrive at current time of scheduler, step() simulates
+ *  one tick and advance_to() jumps between decision points up to given time, no input is parsed and no output is
+ *  printed (compile with -DSCHED_NO_MAIN and include main.cpp to embed the simulator) */
+class scheduler
+{
+public:
+    /*! creates scheduler of given configuration (checked), metrics are always collected */
+    explicit scheduler(const schedule_config& config) : config(config)
+    {
+        this->config.check();
+        with_policy(this->config.method, [&](auto policy)
+        {
+            engine = std::make_unique<policy_engine<decltype(policy)>>(this->config);
+        });
+    }
+
+    /*! submits job arriving at current time (it is scheduled by the next simulated tick), job with burst_time executes
+     *  in CPU bursts of burst_time ticks separated by I/O bursts of io_time ticks */
+    void submit(int id, int priority, unsigned int exec_time, unsigned int burst_time = 0, unsigned int io_time = 0)
+    {
+        if((burst_time == 0) != (io_time == 0)) throw std::invalid_argument("invalid burst times");
+        proc_data pd{};
+        pd.id = id;
+        pd.priority = priority;
+        pd.exec_time = exec_time;
+        pd.burst_time = burst_time;
+        pd.io_time = io_time;
+        pd.seq = seq++;
+        engine->submit(pd);
+    }
+    /*! simulates one tick, returns CPUS states of it */
+    const std::vector<int>& step()
+    {
+        advance_to(now + 1);
+        return cpus_state();
+    }
+    /*! simulates ticks until given time (ticks between decision points are simulated at once) */
+    void advance_to(unsigned int time)
+    {
+        if(time <= now) return;
+        engine->run(now, time);
+        now = time; // scheduler is idle after the last decision point
+    }
+    /*! simulates until all submitted jobs end, returns time after the last executed tick */
+    unsigned int finish()
+    {
+        now = engine->run(now, std::numeric_limits<unsigned int>::max());
+        return now;
+    }
+
+    unsigned int time() const {return now;} /*!< current time (the next simulated tick) */
+    const std::vector<int>& cpus_state() const {return engine->cpus_state();} /*!< CPUS states of the last tick */
+    std::size_t jobs() const {return engine->jobs();} /*!< number of submitted jobs that have not ended yet (blocked too) */
+    bool idle() const {return engine->jobs() == 0;} /*!< checks if all submitted jobs have ended */
+    const schedule_metrics& metrics() const {return engine->metrics();} /*!< metrics of ended jobs */
+    const schedule_config& configuration() const {return config;} /*!< configuration of simulation */
 
-    std::vector<proc_data> proc_list; // processes execution list
-    std::vector<int> cpus_state(cpu_count); // CPU states list
-    unsigned int time = 0; // simulation time
-    bool read = true; // flag for reading input
-    while(read || !all_cpus_sleeping(cpus_state)) // run until there is no input and all CPUS are sleeping
+private:
+    /*! simulation of one policy behind type independent interface */
+    struct engine_base
     {
-        // read input
-        if(read)
+        virtual ~engine_base() = default;
+        virtual void submit(const proc_data& pd) = 0;
+        virtual unsigned int run(unsigned int time, unsigned int end) = 0;
+        virtual const std::vector<int>& cpus_state() const = 0;
+        virtual std::size_t jobs() const = 0;
+        virtual const schedule_metrics& metrics() const = 0;
+    };
+
+    /*! simulation of given policy (the same schedule and execution steps as simulation engine) */
+    template<typename Policy>
+    struct policy_engine final : engine_base
+    {
+        explicit policy_engine(const schedule_config& config) : config(config), state(this->config) {}
+
+        void submit(const proc_data& pd) override {state.arrivals.push_back(pd);}
+        /*! simulates ticks [time, end) until there is no job, returns time after the last executed tick */
+        unsigned int run(unsigned int time, unsigned int end) override
         {
-            std::string line;
-            std::getline(std::cin, line);
-            std::istringstream ss(line);
-            if (ss.rdbuf()->in_avail() != 0)
+            while(time < end)
             {
-                ss >> time;
-                while (ss.rdbuf()->in_avail() / 2 >= 3)
-                {
-                    proc_data pd{};
-                    ss >> pd;
-                    proc_list.push_back(pd);
-                }
+                if(!state.arrivals.empty()) push_arrivals(config, state, time);
+                schedule(config, state, time);
+                if(state.proc_list.live() == 0 && state.admission.empty()) break;
+                unsigned int ticks = std::min(ticks_to_decision(state, time), end - time);
+                execute(state, &summary, time, ticks);
+                time += ticks;
             }
-            else read = false;
+            return time;
+        }
+        const std::vector<int>& cpus_state() const override {return state.cpus_state;}
+        std::size_t jobs() const override
+        {
+            return state.proc_list.live() + state.admission.size() + state.arrivals.size();
         }
-        // run given method
-        switch (method)
+        const schedule_metrics& metrics() const override {return summary;}
+
+        const schedule_config config; /*!< configuration of scheduler (own copy, scheduler is movable) */
+        schedule_state<Policy> state; /*!< simulation state */
+        schedule_metrics summary; /*!< metrics of ended jobs */
+    };
+
+    schedule_config config; /*!< configuration of simulation */
+    std::unique_ptr<engine_base> engine; /*!< simulation of configured policy */
+    unsigned int now = 0; /*!< current time */
+    unsigned int seq = 0; /*!< arrival sequence number */
+};
+
+/*! runs one simulation of given configuration (or continues checkpointed one), prints its result (and metrics) to out */
+template<typename Reader>
+void run_simulation(Reader& reader, output_writer& out, const schedule_config& config, snapshot_reader* resume = nullptr)
+{
+    schedule_printer printer(out, config.format); // printer of scheduling result
+    std::unique_ptr<schedule_metrics> metrics = config.metrics ? std::make_unique<schedule_metrics>() : nullptr;
+    with_policy(config.method, [&](auto policy)
+    {
+        using Policy = decltype(policy);
+        run_engine<Policy>(reader, printer, config, metrics.get(), resume);
+    });
+    printer.finish();
+    if(metrics) metrics->print(out, config.cpu_count);
+}
+
+/*! runs one simulation pipelined on three threads, reader thread parses input, simulation formats output and writer
+ *  thread writes it to file descriptor, threads pass blocks through bounded SPSC queues */
+void run_pipelined(input_parser& parser, int fd, const schedule_config& config)
+{
+    constexpr std::size_t queue_capacity = 16; // blocks in flight between threads
+    constexpr std::size_t block_lines = 4096; // input lines of arrival block
+    spsc_queue<arrival_block> arrivals(queue_capacity); // parsed input
+    spsc_queue<std::vector<char>> blocks(queue_capacity); // formatted output
+    spsc_queue<std::vector<char>> recycled(queue_capacity * 2); // written output blocks reused by simulation
+    std::exception_ptr read_error; // error of reader thread
+    std::exception_ptr write_error; // error of writer thread
+    std::thread reader([&]()
+    {
+        try
         {
-            case 0: // FCFS
+            arrival_block block;
+            unsigned int time;
+            unsigned int seq = 0;
+            while(parser.read(time, block.procs, seq))
             {
-                fcfs(proc_list, cpus_state);
-                break;
+                block.lines.push_back({time, block.procs.size()});
+                if(block.lines.size() < block_lines) continue;
+                if(!arrivals.push(std::move(block))) return;
+                block = arrival_block();
             }
-            case 1: // SJF
+            if(!block.lines.empty()) arrivals.push(std::move(block));
+        }
+        catch(...)
+        {
+            read_error = std::current_exception();
+        }
+        arrivals.push(arrival_block()); // end of input
+    });
+    std::thread writer([&]()
+    {
+        try
+        {
+            std::vector<char> block;
+            for(blocks.pop(block); !block.empty(); blocks.pop(block))
             {
-                sjf(proc_list, cpus_state);
-                break;
+                write_all(fd, block.data(), block.size());
+                recycled.try_push(block); // block is dropped if simulation has enough blocks
             }
-            case 2: // SRTF
+        }
+        catch(...)
+        {
+            write_error = std::current_exception();
+            blocks.close();
+        }
+    });
+    try
+    {
+        pipe_reader input(arrivals);
+        output_writer out(blocks, &recycled);
+        run_simulation(input, out, config);
+        out.flush();
+    }
+    catch(...)
+    {
+        arrivals.close();
+        blocks.push(std::vector<char>());
+        reader.join();
+        writer.join();
+        if(write_error) std::rethrow_exception(write_error); // the first failure (simulation stopped by it)
+        throw;
+    }
+    blocks.push(std::vector<char>()); // end of output
+    reader.join();
+    writer.join();
+    if(read_error) std::rethrow_exception(read_error);
+    if(write_error) std::rethrow_exception(write_error);
+}
+
+/*! simulated ticks per second of benchmarked configuration */
+struct bench_result
+{
+    unsigned int method; /*!< schedule method */
+    unsigned int cpu_count; /*!< number of CPUS */
+    unsigned int rr_time; /*!< Round Robin slice time */
+    unsigned long long ticks; /*!< number of simulated ticks */
+    double ticks_per_second; /*!< simulated ticks per second */
+};
+
+/*! reads results of previous benchmark (its output) */
+std::vector<bench_result> read_bench_results(const char* path)
+{
+    std::FILE* file = std::fopen(path, "r");
+    if(file == nullptr) throw std::invalid_argument(std::string("cannot open benchmark baseline ") + path);
+    std::vector<bench_result> results;
+    char line[512];
+    while(std::fgets(line, sizeof(line), file) != nullptr)
+    {
+        bench_result result{};
+        unsigned long long jobs;
+        double seconds;
+        if(std::sscanf(line, "%u %u %u %llu %llu %lf %lf", &result.method, &result.cpu_count, &result.rr_time, &jobs,
+                       &result.ticks, &seconds, &result.ticks_per_second) == 7)
+            results.push_back(result);
+    }
+    std::fclose(file);
+    return results;
+}
+
+/*! benchmarks given configurations on synthetic workload, prints simulated ticks per second and nanoseconds per tick
+ *  of every configuration, with baseline results ratio of ticks per second to the baseline is printed too, returns
+ *  number of configurations slower than baseline by more than max_slowdown percent or simulating different number of
+ *  ticks (the same workload, so simulation has changed) */
+std::size_t run_benchmark(const workload_config& workload, const std::vector<schedule_config>& configs, output_writer& out,
+                          const std::vector<bench_result>* baseline = nullptr, double max_slowdown = 10.0,
+                          unsigned int repeat = 1)
+{
+    std::size_t regressions = 0;
+    out << "method cpus rr_time jobs ticks seconds ticks/s ns/tick" << (baseline != nullptr ? " baseline_ratio\n" : "\n");
+    for(auto & config: configs)
+    {
+        unsigned int ticks = 0; // simulated ticks
+        double seconds = std::numeric_limits<double>::max(); // the fastest run
+        for(unsigned int run = 0; run < std::max(repeat, 1u); ++run)
+        {
+            workload_generator generator(workload); // the same workload for every combination
+            output_writer sink(-1); // CPUS states are not printed
+            schedule_printer printer(sink, output_format::none);
+            auto begin = std::chrono::steady_clock::now();
+            with_policy(config.method, [&](auto policy)
             {
-                srtf(proc_list, cpus_state);
-                break;
-            }
-            case 3: // RR
+                using Policy = decltype(policy);
+                ticks = run_engine<Policy>(generator, printer, config, nullptr);
+            });
+            seconds = std::min(seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+        out << config.method << ' ' << config.cpu_count << ' ' << config.rr_time << ' ' << workload.jobs << ' ' << ticks << ' ';
+        out.fixed(seconds, 6) << ' ';
+        out.fixed(seconds == 0.0 ? 0.0 : ticks / seconds, 0) << ' ';
+        out.fixed(ticks == 0 ? 0.0 : seconds * 1e9 / ticks, 2);
+        if(baseline != nullptr)
+        {
+            auto it = std::find_if(baseline->begin(), baseline->end(), [&](const bench_result& result)
             {
-                rr(proc_list, cpus_state, rr_time);
-                break;
+                return result.method == config.method && result.cpu_count == config.cpu_count &&
+                       result.rr_time == config.rr_time;
+            });
+            if(it == baseline->end()) throw std::invalid_argument("combination is missing in benchmark baseline");
+            double ratio = seconds == 0.0 || it->ticks_per_second == 0.0 ? 1.0 : ticks / seconds / it->ticks_per_second;
+            out << ' ';
+            out.fixed(ratio, 3);
+            if(ratio < 1.0 - max_slowdown / 100.0) out << " SLOWER";
+            if(it->ticks != ticks) out << " DIFFERENT_TICKS";
+            regressions += ratio < 1.0 - max_slowdown / 100.0 || it->ticks != ticks;
+        }
+        out << '\n';
+    }
+    return regressions;
+}
+
+/*! parses comma separated list of numbers and ranges (e.g. 0-6,8) */
+std::vector<unsigned int> parse_list(const char* arg)
+{
+    std::vector<unsigned int> values;
+    for(char* it = const_cast<char*>(arg); *it != '\0'; it += (*it == ','))
+    {
+        char* begin = it;
+        auto first = static_cast<unsigned int>(std::strtoul(it, &it, 0));
+        auto last = first;
+        if(*it == '-') last = static_cast<unsigned int>(std::strtoul(it + 1, &it, 0));
+        if(it == begin || (*it != ',' && *it != '\0') || last < first) throw std::invalid_argument("invalid list argument");
+        for(unsigned int value = first; value <= last && value >= first; ++value)
+            values.push_back(value);
+    }
+    return values;
+}
+
+/*! compares output in file with golden file, returns 0 if they are equal, otherwise number of the first different line
+ *  (counted from 1) */
+std::size_t compare_output(std::FILE* file, std::FILE* golden)
+{
+    std::size_t line = 1;
+    char block[1 << 16];
+    char golden_block[1 << 16];
+    while(true)
+    {
+        std::size_t count = std::fread(block, 1, sizeof(block), file);
+        std::size_t golden_count = std::fread(golden_block, 1, sizeof(golden_block), golden);
+        std::size_t same = 0;
+        while(same < std::min(count, golden_count) && block[same] == golden_block[same])
+            line += block[same++] == '\n';
+        if(same != count || same != golden_count) return line;
+        if(count == 0) return 0;
+    }
+}
+
+/*! runs all configurations on shared trace using jobs threads, result of every configuration is written to its own
+ *  file m<method>_c<cpus>_q<rr slice time>.out in given directory, with check result is compared with existing file
+ *  (golden output) instead and every difference is reported to out, returns number of differences */
+std::size_t run_batch(const arrival_trace& trace, const std::vector<schedule_config>& configs,
+                      const std::string& directory, unsigned int jobs, bool check = false, output_writer* out = nullptr)
+{
+    std::size_t failures = 0; // configurations which output differs from golden output
+    std::atomic<std::size_t> next{0}; // next configuration to run
+    std::exception_ptr error; // first error of worker threads
+    std::mutex error_mutex; // guards error
+    auto worker = [&]()
+    {
+        for(std::size_t i; (i = next.fetch_add(1)) < configs.size();)
+        {
+            try
+            {
+                const schedule_config& config = configs[i];
+                std::string path = directory + "/m" + std::to_string(config.method) + "_c" +
+                                   std::to_string(config.cpu_count) + "_q" + std::to_string(config.rr_time) + ".out";
+                if(!check)
+                {
+                    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                    if(fd < 0) throw std::invalid_argument("cannot open batch output file " + path);
+                    {
+                        output_writer out(fd); // output of this configuration
+                        trace_reader reader(trace);
+                        run_simulation(reader, out, config);
+                    }
+                    ::close(fd);
+                    continue;
+                }
+                // output goes to temporary file compared with golden output
+                std::unique_ptr<std::FILE, int (*)(std::FILE*)> result(std::tmpfile(), std::fclose);
+                if(result == nullptr) throw std::runtime_error("cannot create temporary file");
+                {
+                    output_writer result_out(::fileno(result.get()));
+                    trace_reader reader(trace);
+                    run_simulation(reader, result_out, config);
+                }
+                std::rewind(result.get());
+                std::unique_ptr<std::FILE, int (*)(std::FILE*)> golden(std::fopen(path.c_str(), "rb"), std::fclose);
+                std::size_t line = golden != nullptr ? compare_output(result.get(), golden.get()) : 0;
+                if(golden != nullptr && line == 0) continue;
+                std::lock_guard<std::mutex> lock(error_mutex);
+                ++failures;
+                out->write(path.data(), path.size());
+                if(golden == nullptr) *out << " missing golden output\n";
+                else *out << " differs at line " << line << '\n';
             }
-            case 4: // Priority_FCFS
+            catch(...)
             {
-                prio_fcfs(proc_list, cpus_state);
-                break;
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) error = std::current_exception();
+                next = configs.size();
             }
-            case 5: // Priority_SRTF
+        }
+    };
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < std::min<std::size_t>(jobs, configs.size()); ++i)
+        threads.emplace_back(worker);
+    worker();
+    for(auto & thread: threads)
+        thread.join();
+    if(error) std::rethrow_exception(error);
+    if(check) *out << "checked " << configs.size() << " failed " << failures << '\n';
+    return failures;
+}
+
+/*! trace of sweep mode, parsed by the first worker which needs it and released after its last configuration */
+struct sweep_trace
+{
+    std::string path; /*!< input file, "-" is stdin */
+    std::mutex mutex; /*!< guards trace and pending */
+    std::shared_ptr<const arrival_trace> trace; /*!< parsed input */
+    std::size_t pending = 0; /*!< number of configurations of this process which have not finished yet */
+};
+
+/*! runs every configuration on every trace (trace-major order) using jobs threads, only contiguous block shard_index of
+ *  shard_count equal blocks of combinations is run by this process (it parses about 1/shard_count of traces), one
+ *  metrics row per combination is written to output as soon as it finishes (header is written by the first shard only,
+ *  so outputs of all shards can be concatenated) */
+void run_sweep(const std::vector<std::string>& paths, const std::vector<schedule_config>& configs,
+               std::size_t shard_index, std::size_t shard_count, unsigned int jobs, output_writer& out)
+{
+    std::vector<sweep_trace> traces(paths.size());
+    std::vector<std::size_t> items; // combinations of this shard, index is trace * configs + config
+    std::size_t total = paths.size() * configs.size();
+    for(std::size_t i = total * shard_index / shard_count; i < total * (shard_index + 1) / shard_count; ++i)
+    {
+        items.push_back(i);
+        ++traces[i / configs.size()].pending;
+    }
+    for(std::size_t i = 0; i < paths.size(); ++i)
+        traces[i].path = paths[i];
+    if(shard_index == 0) out << "trace method cpus rr_time " << schedule_metrics::row_header << '\n';
+    out.flush();
+    std::atomic<std::size_t> next{0}; // next combination to run
+    std::exception_ptr error; // first error of worker threads
+    std::mutex mutex; // guards error and out
+    auto worker = [&]()
+    {
+        for(std::size_t i; (i = next.fetch_add(1)) < items.size();)
+        {
+            try
             {
-                prio_srtf(proc_list, cpus_state);
-                break;
+                sweep_trace& input = traces[items[i] / configs.size()];
+                const schedule_config& config = configs[items[i] % configs.size()];
+                std::shared_ptr<const arrival_trace> trace;
+                {
+                    std::lock_guard<std::mutex> lock(input.mutex);
+                    if(!input.trace)
+                    {
+                        auto parser = input.path == "-" ? std::make_unique<input_parser>(stdin)
+                                                        : std::make_unique<input_parser>(input.path.c_str());
+                        input.trace = std::make_shared<const arrival_trace>(*parser);
+                    }
+                    trace = input.trace;
+                }
+                schedule_metrics metrics;
+                {
+                    trace_reader reader(*trace);
+                    output_writer sink(-1); // CPUS states are not printed
+                    schedule_printer printer(sink, output_format::none);
+                    with_policy(config.method, [&](auto policy)
+                    {
+                        run_engine<decltype(policy)>(reader, printer, config, &metrics);
+                    });
+                }
+                {
+                    std::lock_guard<std::mutex> lock(input.mutex);
+                    if(--input.pending == 0) input.trace.reset(); // the last configuration of trace
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                out.write(input.path.data(), input.path.size()) << ' ' << config.method << ' ' << config.cpu_count << ' ';
+                out << config.rr_time << ' ';
+                metrics.print_row(out, config.cpu_count);
+                out << '\n';
+                out.flush();
             }
-            case 6: // Priority without preemption (FCFS)
+            catch(...)
             {
-                prio_fcfs_no_preemption(proc_list, cpus_state);
-                break;
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!error) error = std::current_exception();
+                next = items.size();
             }
-            default: // Wrong method, raises error
-                throw std::invalid_argument("invalid schedule method");
+        }
+    };
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < std::min<std::size_t>(jobs, items.size()); ++i)
+        threads.emplace_back(worker);
+    worker();
+    for(auto & thread: threads)
+        thread.join();
+    if(error) std::rethrow_exception(error);
+}
 
+/*! runs program with given arguments */
+int run(int argc, char* argv[])
+{
+    schedule_config config; // configuration of simulation
+    bool expand = false; // per tick output of event-driven engine (--expand)
+    int output_fd = STDOUT_FILENO; // output file descriptor (--output-fd)
+    const char* input_path = nullptr; // memory mapped input file (--input), stdin if not given
+    char convert = 0; // input conversion to binary ('b', --to-binary) or text ('t', --to-text) trace
+    bool changes = false; // CPUS states changes output (--changes)
+    bool binary_changes = false; // binary CPUS states changes output (--binary-changes)
+    bool decode = false; // decoding of CPUS states changes (--decode-changes)
+    bool pipeline = false; // reader, simulation and writer threads (--pipeline)
+    bool metrics_only = false; // metrics summary without CPUS states (--metrics-only)
+    const char* batch[3] = {}; // lists of methods, CPUS counts and RR slice times of batch mode (--batch)
+    std::string batch_dir = "."; // directory of batch mode results (--batch-dir)
+    bool batch_check = false; // batch results are compared with golden outputs in batch directory (--batch-check)
+    const char* baseline_path = nullptr; // results of previous benchmark (--baseline)
+    double max_slowdown = 10.0; // percent of ticks per second benchmark may lose against baseline (--max-slowdown)
+    unsigned int bench_repeat = 1; // runs of every benchmark combination, the fastest is printed (--bench-repeat)
+    unsigned int jobs = std::max(std::thread::hardware_concurrency(), 1u); // number of batch mode threads (--jobs)
+    workload_config workload; // synthetic workload (--gen-*, --seed)
+    bool generate = false; // synthetic workload instead of input (--generate)
+    const char* bench[3] = {}; // lists of methods, CPUS counts and RR slice times of benchmark (--bench)
+    const char* resume_path = nullptr; // checkpoint of resumed simulation (--resume)
+    const char* sweep[3] = {}; // lists of methods, CPUS counts and RR slice times of sweep mode (--sweep)
+    std::size_t shard_index = 0; // combinations of sweep mode run by this process (--shard)
+    std::size_t shard_count = 1;
+    // split options from positional arguments
+    std::vector<char*> args;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if(arg == "--event") config.event_driven = true;
+        else if(arg == "--expand") expand = true;
+        else if(arg == "--input" && i + 1 < argc) input_path = argv[++i];
+        else if(arg == "--to-binary") convert = 'b';
+        else if(arg == "--to-text") convert = 't';
+        else if(arg == "--changes") changes = true;
+        else if(arg == "--binary-changes") binary_changes = true;
+        else if(arg == "--decode-changes") decode = true;
+        else if(arg == "--pipeline") pipeline = true;
+        else if(arg == "--metrics") config.metrics = true;
+        else if(arg == "--metrics-only") config.metrics = metrics_only = true;
+        else if(arg == "--affinity") config.affinity.enabled = true;
+        else if(arg == "--switch-cost" && i + 1 < argc)
+            config.affinity.switch_cost = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--migration-cost" && i + 1 < argc)
+            config.affinity.migration_cost = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--local-method" && i + 1 < argc)
+            config.local_method = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--steal-threshold" && i + 1 < argc)
+            config.steal_threshold = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--mlfq-levels" && i + 1 < argc)
+            config.mlfq_levels = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--mlfq-quanta" && i + 1 < argc) config.mlfq_quanta = parse_list(argv[++i]);
+        else if(arg == "--mlfq-boost" && i + 1 < argc)
+            config.mlfq_boost = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--min-granularity" && i + 1 < argc)
+            config.min_granularity = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--batch" && i + 3 < argc)
+        {
+            for(auto & list: batch)
+                list = argv[++i];
         }
-        // update proc_list
-        for(auto id: cpus_state)
+        else if(arg == "--batch-dir" && i + 1 < argc) batch_dir = argv[++i];
+        else if(arg == "--batch-check") batch_check = true;
+        else if(arg == "--baseline" && i + 1 < argc) baseline_path = argv[++i];
+        else if(arg == "--max-slowdown" && i + 1 < argc) max_slowdown = std::strtod(argv[++i], nullptr);
+        else if(arg == "--bench-repeat" && i + 1 < argc)
+            bench_repeat = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--sweep" && i + 3 < argc)
         {
-            auto it_proc = proc_list.begin();
-            if(id == -1) continue;
-            while(it_proc->id != id) ++it_proc;
-            // pop an executed process
-            if(--(it_proc->remaining_time) == 0)
-                proc_list.erase(it_proc);
+            for(auto & list: sweep)
+                list = argv[++i];
         }
-        // print output
-        std::cout << time++;
-        for(auto & cpu_state: cpus_state)
-            std::cout << " " << cpu_state;
-        std::cout << "\n";
+        else if(arg == "--shard" && i + 1 < argc)
+        {
+            char* end = nullptr;
+            shard_index = std::strtoull(argv[++i], &end, 0);
+            if(*end != '/') throw std::invalid_argument("invalid shard (expected index/count)");
+            shard_count = std::strtoull(end + 1, &end, 0);
+            if(*end != '\0' || shard_count == 0 || shard_index >= shard_count)
+                throw std::invalid_argument("invalid shard (expected index/count)");
+        }
+        else if(arg == "--jobs" && i + 1 < argc) jobs = static_cast<unsigned int>(std::strtol(argv[++i], nullptr, 0));
+        else if(arg == "--capacity" && i + 1 < argc) config.capacity = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--backlog-limit" && i + 1 < argc) config.backlog_limit = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--spill-limit" && i + 1 < argc) config.spill_limit = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--lookahead" && i + 1 < argc) config.lookahead = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--cpu-threads" && i + 1 < argc)
+            config.cpu_threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--checkpoint" && i + 1 < argc) config.checkpoint_path = argv[++i];
+        else if(arg == "--checkpoint-every" && i + 1 < argc)
+            config.checkpoint_interval = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--resume" && i + 1 < argc) resume_path = argv[++i];
+        else if(arg == "--generate") generate = true;
+        else if(arg == "--bench" && i + 3 < argc)
+        {
+            for(auto & list: bench)
+                list = argv[++i];
+        }
+        else if(arg == "--gen-jobs" && i + 1 < argc) workload.jobs = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--gen-rate" && i + 1 < argc) workload.rate = std::strtod(argv[++i], nullptr);
+        else if(arg == "--gen-exec-min" && i + 1 < argc)
+            workload.exec_min = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--gen-exec-alpha" && i + 1 < argc) workload.exec_alpha = std::strtod(argv[++i], nullptr);
+        else if(arg == "--gen-exec-max" && i + 1 < argc)
+            workload.exec_max = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--gen-priorities" && i + 1 < argc) workload.priorities = parse_list(argv[++i]);
+        else if(arg == "--seed" && i + 1 < argc) workload.seed = std::strtoull(argv[++i], nullptr, 0);
+        else if(arg == "--output-fd" && i + 1 < argc) output_fd = static_cast<int>(std::strtol(argv[++i], nullptr, 0));
+        else args.push_back(argv[i]);
+    }
+    if((!config.checkpoint_path.empty() || resume_path != nullptr) && (pipeline || batch[0] != nullptr || bench[0] != nullptr ||
+                                                                    sweep[0] != nullptr))
+        throw std::invalid_argument("checkpoints are not supported in pipelined, batch, sweep and benchmark modes");
+    output_writer out(output_fd); // output of scheduling
+    if(decode)
+    {
+        std::FILE* file = input_path != nullptr ? std::fopen(input_path, "rb") : stdin;
+        if(file == nullptr) throw std::invalid_argument("cannot open input file");
+        decode_changes(file, out);
+        if(file != stdin) std::fclose(file);
+        return 0;
+    }
+    if(generate && bench[0] == nullptr)
+    {
+        // write synthetic workload as input trace
+        workload_generator generator(workload);
+        if(convert == 'b') convert_to_binary(generator, out);
+        else convert_to_text(generator, out);
+        return 0;
+    }
+    if(bench[0] != nullptr)
+    {
+        // every combination of methods, CPUS counts and RR slice times on synthetic workload
+        std::vector<schedule_config> configs;
+        for(auto method: parse_list(bench[0]))
+            for(auto cpu_count: parse_list(bench[1]))
+                for(auto rr_time: parse_list(bench[2]))
+                {
+                    configs.push_back(config);
+                    configs.back().method = method;
+                    configs.back().cpu_count = cpu_count;
+                    configs.back().rr_time = rr_time;
+                    configs.back().check();
+                }
+        if(baseline_path == nullptr)
+        {
+            run_benchmark(workload, configs, out, nullptr, max_slowdown, bench_repeat);
+            return 0;
+        }
+        std::vector<bench_result> baseline = read_bench_results(baseline_path);
+        return run_benchmark(workload, configs, out, &baseline, max_slowdown, bench_repeat) == 0 ? 0 : 1;
+    }
+    if(sweep[0] != nullptr)
+    {
+        // every combination of methods, CPUS counts and RR slice times on every trace (positional arguments)
+        std::vector<schedule_config> configs;
+        for(auto method: parse_list(sweep[0]))
+            for(auto cpu_count: parse_list(sweep[1]))
+                for(auto rr_time: parse_list(sweep[2]))
+                {
+                    configs.push_back(config);
+                    configs.back().method = method;
+                    configs.back().cpu_count = cpu_count;
+                    configs.back().rr_time = rr_time;
+                    configs.back().format = output_format::none;
+                    configs.back().check();
+                }
+        std::vector<std::string> paths; // traces, @file arguments are files with one trace path per line
+        for(auto arg: args)
+        {
+            if(arg[0] != '@')
+            {
+                paths.emplace_back(arg);
+                continue;
+            }
+            std::FILE* file = std::fopen(arg + 1, "r");
+            if(file == nullptr) throw std::invalid_argument(std::string("cannot open trace list ") + (arg + 1));
+            char line[4096];
+            while(std::fgets(line, sizeof(line), file) != nullptr)
+            {
+                std::string path(line, std::strcspn(line, "\r\n"));
+                if(!path.empty()) paths.push_back(path);
+            }
+            std::fclose(file);
+        }
+        if(input_path != nullptr) paths.emplace_back(input_path);
+        if(paths.empty()) paths.emplace_back("-");
+        run_sweep(paths, configs, shard_index, shard_count, std::max(jobs, 1u), out);
+        return 0;
+    }
+    std::unique_ptr<input_parser> parser = input_path != nullptr ? std::make_unique<input_parser>(input_path)
+                                                                 : std::make_unique<input_parser>(stdin); // input
+    // convert input trace
+    if(convert == 'b') convert_to_binary(*parser, out);
+    if(convert == 't') convert_to_text(*parser, out);
+    if(convert != 0) return 0;
+
+    config.format = config.event_driven && !expand ? output_format::runs : output_format::ticks;
+    if(changes) config.format = output_format::changes;
+    if(binary_changes) config.format = output_format::binary_changes;
+    if(metrics_only) config.format = output_format::none;
+    if(resume_path != nullptr)
+    {
+        // continue checkpointed simulation, parameters of simulation are taken from checkpoint
+        snapshot_reader snapshot(resume_path);
+        std::uint64_t output_length = read_checkpoint_header(snapshot, config);
+        config.check();
+        truncate_output(output_fd, output_length);
+        run_simulation(*parser, out, config, &snapshot);
+        return 0;
+    }
+    if(batch[0] != nullptr)
+    {
+        // every combination of methods, CPUS counts and RR slice times
+        std::vector<schedule_config> configs;
+        for(auto method: parse_list(batch[0]))
+            for(auto cpu_count: parse_list(batch[1]))
+                for(auto rr_time: parse_list(batch[2]))
+                {
+                    configs.push_back(config);
+                    configs.back().method = method;
+                    configs.back().cpu_count = cpu_count;
+                    configs.back().rr_time = rr_time;
+                    configs.back().check();
+                }
+        arrival_trace trace(*parser); // input parsed once
+        parser.reset();
+        return run_batch(trace, configs, batch_dir, std::max(jobs, 1u), batch_check, &out) == 0 ? 0 : 1;
     }
+    // read first argument (schedule method)
+    if(args.empty()) throw std::invalid_argument("arg1 not given (schedule method)");
+    else config.method = static_cast<unsigned int>(std::strtol(args[0], nullptr, 0));
+    // check for second argument (CPU count)
+    if(args.size() >= 2) config.cpu_count = static_cast<unsigned int>(std::strtol(args[1], nullptr, 0));
+    // check for third argument (round robin time step)
+    if(args.size() >= 3) config.rr_time = static_cast<unsigned int>(std::strtol(args[2], nullptr, 0));
+    config.check();
+    if(pipeline) run_pipelined(*parser, output_fd, config);
+    else run_simulation(*parser, out, config);
     return 0;
 }
 
+#ifndef SCHED_NO_MAIN
+int main(int argc, char* argv[])
+{
+    int result = run(argc, argv);
+    PROFILE_REPORT();
+    return result;
+}
+#endif